@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "game_manager.h"
+
+// Отдельная сборка тестов с подмененным глобальным operator new: пока
+// идет замер, каждое выделение памяти в любом потоке (включая пул и
+// фоновые журналы) увеличивает счетчик. Установившийся тик - движение,
+// поиск, разрешение боев и уведомления - не должен выделять ничего.
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<uint64_t> allocations{0};
+
+void* countedAllocate(std::size_t size, std::size_t alignment = 0) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) size = 1;
+    void* pointer = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+    return pointer;
+}
+
+// Считает выделения, сделанные за время жизни объекта
+class AllocationCounter {
+public:
+    AllocationCounter() {
+        allocations.store(0, std::memory_order_relaxed);
+        counting.store(true, std::memory_order_seq_cst);
+    }
+    ~AllocationCounter() { stop(); }
+
+    uint64_t stop() {
+        counting.store(false, std::memory_order_seq_cst);
+        return allocations.load(std::memory_order_relaxed);
+    }
+};
+
+}
+
+void* operator new(std::size_t size) {
+    if (void* pointer = countedAllocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* pointer = countedAllocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* pointer = countedAllocate(size, static_cast<std::size_t>(alignment))) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* pointer = countedAllocate(size, static_cast<std::size_t>(alignment))) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace {
+
+// За прогрев население падает с 4000 до ~700 и хранилище один раз отдает
+// лишнюю память (NpcStore::releaseSpare) - это обвал, а не установившийся тик
+constexpr uint32_t WARMUP_TICKS = 100;
+constexpr uint32_t MEASURED_TICKS = 50;
+
+SimulationConfig steadyStateConfig(size_t threads) {
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 4000;
+    config.mapWidth = config.mapHeight = 1500;
+    config.seed = 3;
+    config.threads = threads;
+    return config;
+}
+
+// Прогревает мир и возвращает число выделений за MEASURED_TICKS тиков;
+// deaths - сколько смертей (а значит уведомлений) пришлось на замер
+uint64_t allocationsInSteadyState(const SimulationConfig& config, uint64_t& deaths) {
+    GameManager game(config);
+    game.runTicks(WARMUP_TICKS);
+    uint64_t before = game.getReport().deaths;
+
+    uint64_t counted;
+    {
+        AllocationCounter counter;
+        game.runTicks(MEASURED_TICKS);
+        counted = counter.stop();
+    }
+
+    deaths = game.getReport().deaths - before;
+    return counted;
+}
+
+}
+
+TEST(AllocationTest, CounterSeesAllocations) {
+    // Прямой вызов operator new компилятор не вправе убрать, в отличие от new-выражения
+    AllocationCounter counter;
+    void* volatile block = ::operator new(64);
+    uint64_t counted = counter.stop();
+    ::operator delete(block);
+    EXPECT_EQ(counted, 1u);
+}
+
+TEST(AllocationTest, NameFormattingDoesNotAllocate) {
+    NameTable& names = NameTable::global();
+    NameId interned = names.intern("Гэндальф");
+    NameBuffer buffer;
+    
+    size_t length = 0;
+    AllocationCounter counter;
+    length += names.format(NameId::generated(NpcKind::Bear, 123456), buffer).size();
+    length += names.format(interned, buffer).size();
+    uint64_t counted = counter.stop();
+    
+    EXPECT_EQ(counted, 0u);
+    EXPECT_GT(length, 0u);
+}
+
+TEST(AllocationTest, SteadyStateTickDoesNotAllocate) {
+    uint64_t deaths = 0;
+    EXPECT_EQ(allocationsInSteadyState(steadyStateConfig(1), deaths), 0u);
+    EXPECT_GT(deaths, 0u) << "на замер не пришлось ни одного уведомления";
+}
+
+TEST(AllocationTest, SteadyStateTickWithPoolDoesNotAllocate) {
+    uint64_t deaths = 0;
+    EXPECT_EQ(allocationsInSteadyState(steadyStateConfig(4), deaths), 0u);
+    EXPECT_GT(deaths, 0u);
+}
+
+TEST(AllocationTest, MetricsDoNotAllocateBetweenStatsLines) {
+    SimulationConfig config = steadyStateConfig(2);
+    config.metrics = true;
+    config.statsIntervalSeconds = 3600;
+    config.metricsFile = "alloc_test_metrics.prom";
+
+    uint64_t deaths = 0;
+    EXPECT_EQ(allocationsInSteadyState(config, deaths), 0u);
+}
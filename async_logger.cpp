@@ -0,0 +1,146 @@
+#include "async_logger.h"
+#include "tracer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std::chrono;
+
+static int64_t steadyNowNs() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+AsyncLogger::AsyncLogger(int descriptor, std::string prefix, bool ownsDescriptor, size_t capacity)
+    : fd(descriptor), ownsFd(ownsDescriptor), linePrefix(std::move(prefix)), ring(capacity),
+      enqueuedCount(0), writtenCount(0), signal(0), stopping(false), deadlineNs(INT64_MAX),
+      cachedSecond(-1), cachedTime{} {
+    batch.resize(BATCH_SIZE);
+    buffer.reserve(BATCH_SIZE * (Record::TEXT_CAPACITY + linePrefix.size() + 16));
+    worker = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    shutdown();
+}
+
+void AsyncLogger::wake() {
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+void AsyncLogger::log(std::initializer_list<std::string_view> parts) {
+    if (stopping.load(std::memory_order_acquire)) return;
+    
+    Record record;
+    record.time = system_clock::to_time_t(system_clock::now());
+    
+    for (std::string_view part : parts) {
+        size_t room = Record::TEXT_CAPACITY - record.length;
+        size_t size = std::min(room, part.size());
+        std::memcpy(record.text + record.length, part.data(), size);
+        record.length += static_cast<uint32_t>(size);
+    }
+    
+    while (!ring.tryPush(record)) {
+        // Фоновый поток уже остановлен: ждать освобождения места бессмысленно
+        if (stopping.load(std::memory_order_acquire)) return;
+        wake();
+        std::this_thread::yield();
+    }
+    // Считается только попавшая в кольцо запись, иначе flush ждал бы ее до таймаута
+    enqueuedCount.fetch_add(1, std::memory_order_relaxed);
+    wake();
+}
+
+bool AsyncLogger::flush(milliseconds timeout) {
+    uint64_t target = enqueuedCount.load(std::memory_order_relaxed);
+    auto deadline = steady_clock::now() + timeout;
+    
+    wake();
+    while (writtenCount.load(std::memory_order_acquire) < target) {
+        if (steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+void AsyncLogger::shutdown(milliseconds timeout) {
+    if (!worker.joinable()) return;
+    
+    deadlineNs.store(steadyNowNs() + duration_cast<nanoseconds>(timeout).count(),
+                     std::memory_order_relaxed);
+    stopping.store(true, std::memory_order_release);
+    wake();
+    worker.join();
+    
+    if (ownsFd && fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void AsyncLogger::run() {
+    Tracer::setThreadName("logger");
+    while (true) {
+        uint32_t seen = signal.load(std::memory_order_acquire);
+        
+        if (drainBatch() > 0) {
+            if (stopping.load(std::memory_order_acquire) &&
+                steadyNowNs() >= deadlineNs.load(std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        
+        if (stopping.load(std::memory_order_acquire)) break;
+        signal.wait(seen, std::memory_order_acquire);
+    }
+}
+
+size_t AsyncLogger::drainBatch() {
+    size_t count = 0;
+    while (count < BATCH_SIZE && ring.tryPop(batch[count])) {
+        count++;
+    }
+    if (count == 0) return 0;
+    
+    TraceSpan span("log write", "io");
+    buffer.clear();
+    for (size_t i = 0; i < count; i++) {
+        const Record& record = batch[i];
+        if (record.time != cachedSecond) formatTime(record.time);
+        
+        buffer.append(linePrefix);
+        buffer.append(cachedTime, 8);
+        buffer.append(" - ");
+        buffer.append(record.text, record.length);
+        buffer.push_back('\n');
+    }
+    
+    writeAll(buffer.data(), buffer.size());
+    writtenCount.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+void AsyncLogger::formatTime(int64_t seconds) {
+    std::time_t raw = static_cast<std::time_t>(seconds);
+    std::tm local{};
+    localtime_r(&raw, &local);
+    std::strftime(cachedTime, sizeof(cachedTime), "%H:%M:%S", &local);
+    cachedSecond = seconds;
+}
+
+void AsyncLogger::writeAll(const char* data, size_t size) {
+    if (fd < 0) return;
+    
+    while (size > 0) {
+        ssize_t result = ::write(fd, data, size);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += result;
+        size -= static_cast<size_t>(result);
+    }
+}
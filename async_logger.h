@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+#include "mpmc_ring.h"
+
+// Асинхронный журнал: производители кладут записи в lock-free кольцо,
+// фоновый поток форматирует их пачками и отдает в дескриптор одним write().
+// Отметка времени берется при записи, а строка "ЧЧ:ММ:СС" кэшируется
+// и пересчитывается не чаще раза в секунду.
+class AsyncLogger {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    static constexpr size_t BATCH_SIZE = 256;
+    static constexpr std::chrono::milliseconds DEFAULT_SHUTDOWN_TIMEOUT{2000};
+
+private:
+    struct Record {
+        static constexpr size_t TEXT_CAPACITY = 244;
+
+        int64_t time = 0;
+        uint32_t length = 0;
+        char text[TEXT_CAPACITY];
+    };
+
+    int fd;
+    bool ownsFd;
+    const std::string linePrefix;
+    MpmcRing<Record> ring;
+
+    std::atomic<uint64_t> enqueuedCount;
+    std::atomic<uint64_t> writtenCount;
+    std::atomic<uint32_t> signal;
+    std::atomic<bool> stopping;
+    std::atomic<int64_t> deadlineNs;
+    std::thread worker;
+
+    std::vector<Record> batch;
+    std::string buffer;
+    int64_t cachedSecond;
+    char cachedTime[9];
+
+    void run();
+    size_t drainBatch();
+    void formatTime(int64_t seconds);
+    void writeAll(const char* data, size_t size);
+    void wake();
+
+public:
+    // Пишет строки вида "<linePrefix>ЧЧ:ММ:СС - <текст>\n" в fd.
+    // При ownsDescriptor дескриптор закрывается после остановки.
+    AsyncLogger(int descriptor, std::string prefix, bool ownsDescriptor,
+                size_t capacity = DEFAULT_CAPACITY);
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Склеивает части в одну запись; слишком длинный текст обрезается.
+    // Если кольцо заполнено, производитель уступает процессор и ждет.
+    void log(std::initializer_list<std::string_view> parts);
+
+    // Ждет, пока все ранее поставленные записи не окажутся в дескрипторе.
+    // Возвращает false, если не успели за timeout.
+    bool flush(std::chrono::milliseconds timeout = DEFAULT_SHUTDOWN_TIMEOUT);
+
+    // Дописывает очередь не дольше timeout и останавливает фоновый поток
+    void shutdown(std::chrono::milliseconds timeout = DEFAULT_SHUTDOWN_TIMEOUT);
+
+    int descriptor() const { return fd; }
+    uint64_t enqueued() const { return enqueuedCount.load(std::memory_order_relaxed); }
+    uint64_t written() const { return writtenCount.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,193 @@
+#include "batch_mover.h"
+#include "npc_store.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_MOVER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Приведение к [-pi/4, pi/4] и полиномы Тейлора 9/10 степени, точность ~1e-9
+constexpr double PI_2 = 1.57079632679489661923;
+constexpr double TWO_OVER_PI = 0.63661977236758134308;
+
+constexpr double S3 = -1.0 / 6.0;
+constexpr double S5 = 1.0 / 120.0;
+constexpr double S7 = -1.0 / 5040.0;
+constexpr double S9 = 1.0 / 362880.0;
+constexpr double C2 = -1.0 / 2.0;
+constexpr double C4 = 1.0 / 24.0;
+constexpr double C6 = -1.0 / 720.0;
+constexpr double C8 = 1.0 / 40320.0;
+constexpr double C10 = -1.0 / 3628800.0;
+
+inline void sincosScalar(double angle, double& s, double& c) {
+    double q = std::nearbyint(angle * TWO_OVER_PI);
+    double r = angle - q * PI_2;
+    double r2 = r * r;
+    
+    double sr = r + r * r2 * (S3 + r2 * (S5 + r2 * (S7 + r2 * S9)));
+    double cr = 1.0 + r2 * (C2 + r2 * (C4 + r2 * (C6 + r2 * (C8 + r2 * C10))));
+    
+    int quadrant = static_cast<int>(q) & 3;
+    double sv = (quadrant & 1) ? cr : sr;
+    double cv = (quadrant & 1) ? sr : cr;
+    s = (quadrant & 2) ? -sv : sv;
+    c = (quadrant == 1 || quadrant == 2) ? -cv : cv;
+}
+
+void moveScalar(NpcStore& store, const double* directions, const double* fractions,
+                size_t begin, size_t end, double maxX, double maxY) {
+    double* x = store.x.data();
+    double* y = store.y.data();
+    const double* moveDistance = store.moveDistance.data();
+    const uint8_t* alive = store.alive.data();
+    
+    for (size_t i = begin; i < end; i++) {
+        double s, c;
+        sincosScalar(directions[i], s, c);
+        double distance = fractions[i] * moveDistance[i];
+        
+        double newX = std::max(0.0, std::min(x[i] + distance * c, maxX - 1));
+        double newY = std::max(0.0, std::min(y[i] + distance * s, maxY - 1));
+        
+        x[i] = alive[i] ? newX : x[i];
+        y[i] = alive[i] ? newY : y[i];
+    }
+}
+
+#ifdef BATCH_MOVER_X86
+
+__attribute__((target("avx2")))
+size_t moveAvx2(NpcStore& store, const double* directions, const double* fractions,
+                size_t begin, size_t end, double maxX, double maxY) {
+    double* x = store.x.data();
+    double* y = store.y.data();
+    const double* moveDistance = store.moveDistance.data();
+    const uint8_t* alive = store.alive.data();
+    
+    const __m256d twoOverPi = _mm256_set1_pd(TWO_OVER_PI);
+    const __m256d piOver2 = _mm256_set1_pd(PI_2);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d quarter = _mm256_set1_pd(0.25);
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d limitX = _mm256_set1_pd(maxX - 1);
+    const __m256d limitY = _mm256_set1_pd(maxY - 1);
+    
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d angle = _mm256_loadu_pd(directions + i);
+        
+        __m256d q = _mm256_round_pd(_mm256_mul_pd(angle, twoOverPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_sub_pd(angle, _mm256_mul_pd(q, piOver2));
+        __m256d r2 = _mm256_mul_pd(r, r);
+        
+        __m256d sp = _mm256_add_pd(_mm256_set1_pd(S7), _mm256_mul_pd(r2, _mm256_set1_pd(S9)));
+        sp = _mm256_add_pd(_mm256_set1_pd(S5), _mm256_mul_pd(r2, sp));
+        sp = _mm256_add_pd(_mm256_set1_pd(S3), _mm256_mul_pd(r2, sp));
+        __m256d sr = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, r2), sp));
+        
+        __m256d cp = _mm256_add_pd(_mm256_set1_pd(C8), _mm256_mul_pd(r2, _mm256_set1_pd(C10)));
+        cp = _mm256_add_pd(_mm256_set1_pd(C6), _mm256_mul_pd(r2, cp));
+        cp = _mm256_add_pd(_mm256_set1_pd(C4), _mm256_mul_pd(r2, cp));
+        cp = _mm256_add_pd(_mm256_set1_pd(C2), _mm256_mul_pd(r2, cp));
+        __m256d cr = _mm256_add_pd(one, _mm256_mul_pd(r2, cp));
+        
+        // quadrant = q mod 4, затем маски перестановки и смены знака
+        __m256d quadrant = _mm256_sub_pd(q, _mm256_mul_pd(four, _mm256_floor_pd(_mm256_mul_pd(q, quarter))));
+        __m256d odd = _mm256_sub_pd(quadrant, _mm256_mul_pd(two, _mm256_floor_pd(_mm256_mul_pd(quadrant, half))));
+        __m256d swapMask = _mm256_cmp_pd(odd, one, _CMP_EQ_OQ);
+        __m256d sinNeg = _mm256_cmp_pd(quadrant, two, _CMP_GE_OQ);
+        __m256d cosNeg = _mm256_and_pd(_mm256_cmp_pd(quadrant, one, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(quadrant, two, _CMP_LE_OQ));
+        
+        __m256d sv = _mm256_blendv_pd(sr, cr, swapMask);
+        __m256d cv = _mm256_blendv_pd(cr, sr, swapMask);
+        sv = _mm256_xor_pd(sv, _mm256_and_pd(sinNeg, signBit));
+        cv = _mm256_xor_pd(cv, _mm256_and_pd(cosNeg, signBit));
+        
+        __m256d distance = _mm256_mul_pd(_mm256_loadu_pd(fractions + i), _mm256_loadu_pd(moveDistance + i));
+        __m256d oldX = _mm256_loadu_pd(x + i);
+        __m256d oldY = _mm256_loadu_pd(y + i);
+        
+        __m256d newX = _mm256_max_pd(zero, _mm256_min_pd(_mm256_add_pd(oldX, _mm256_mul_pd(distance, cv)), limitX));
+        __m256d newY = _mm256_max_pd(zero, _mm256_min_pd(_mm256_add_pd(oldY, _mm256_mul_pd(distance, sv)), limitY));
+        
+        int32_t aliveBytes;
+        __builtin_memcpy(&aliveBytes, alive + i, sizeof(aliveBytes));
+        __m256i aliveWide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(aliveBytes));
+        __m256d deadMask = _mm256_castsi256_pd(_mm256_cmpeq_epi64(aliveWide, _mm256_setzero_si256()));
+        
+        _mm256_storeu_pd(x + i, _mm256_blendv_pd(newX, oldX, deadMask));
+        _mm256_storeu_pd(y + i, _mm256_blendv_pd(newY, oldY, deadMask));
+    }
+    
+    return i;
+}
+
+#endif
+
+}
+
+BatchMover::BatchMover(bool allowSimd) : kernel(Kernel::Scalar) {
+    if (allowSimd && cpuHasAvx2()) {
+        kernel = Kernel::Avx2;
+    }
+}
+
+bool BatchMover::cpuHasAvx2() {
+#ifdef BATCH_MOVER_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void BatchMover::sincos(double angle, double& sinOut, double& cosOut) {
+    sincosScalar(angle, sinOut, cosOut);
+}
+
+void BatchMover::moveRange(NpcStore& store, const CounterRng& rng, uint32_t tick, size_t begin, size_t end, double maxX, double maxY) {
+    for (size_t i = begin; i < end; i++) {
+        uint32_t id = store.handles[i].index;
+        directions[i] = rng.uniform(id, tick, RngPurpose::MoveDirection) * (2.0 * M_PI);
+        fractions[i] = rng.uniform(id, tick, RngPurpose::MoveDistance);
+    }
+    
+    size_t done = begin;
+#ifdef BATCH_MOVER_X86
+    if (kernel == Kernel::Avx2) {
+        done = moveAvx2(store, directions.data(), fractions.data(), begin, end, maxX, maxY);
+    }
+#endif
+    moveScalar(store, directions.data(), fractions.data(), done, end, maxX, maxY);
+}
+
+void BatchMover::moveAll(NpcStore& store, const CounterRng& rng, uint32_t tick, double maxX, double maxY) {
+    size_t count = store.size();
+    directions.resize(count);
+    fractions.resize(count);
+    moveRange(store, rng, tick, 0, count, maxX, maxY);
+}
+
+void BatchMover::moveAll(NpcStore& store, const CounterRng& rng, uint32_t tick, double maxX, double maxY, ThreadPool& pool) {
+    size_t count = store.size();
+    directions.resize(count);
+    fractions.resize(count);
+    
+    // Случайные числа зависят только от (id, тик), поэтому куски независимы
+    size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        moveRange(store, rng, tick, chunk * CHUNK_SIZE, std::min(count, (chunk + 1) * CHUNK_SIZE), maxX, maxY);
+    });
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class NpcStore;
+class CounterRng;
+class ThreadPool;
+
+// Пакетное перемещение всех живых NPC хранилища. Случайные направления и
+// дальности берутся из CounterRng по (id NPC, тик) в отдельные буферы, после чего координаты
+// обновляются векторным ядром (AVX2) или скалярным, если AVX2 недоступен.
+class BatchMover {
+public:
+    enum class Kernel { Scalar, Avx2 };
+
+private:
+    Kernel kernel;
+    std::vector<double> directions;
+    std::vector<double> fractions;
+
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    void moveRange(NpcStore& store, const CounterRng& rng, uint32_t tick, size_t begin, size_t end, double maxX, double maxY);
+
+public:
+    explicit BatchMover(bool allowSimd = true);
+
+    void moveAll(NpcStore& store, const CounterRng& rng, uint32_t tick, double maxX, double maxY);
+    void moveAll(NpcStore& store, const CounterRng& rng, uint32_t tick, double maxX, double maxY, ThreadPool& pool);
+
+    Kernel getKernel() const { return kernel; }
+    static bool cpuHasAvx2();
+
+    static void sincos(double angle, double& sinOut, double& cosOut);
+};
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "battle_log_format.h"
+#include "npc_kind.h"
+
+// Потоковое чтение бинарного журнала боев (battle_log.bin).
+// Файл отображается в память и читается последовательно, без копирования записей.
+
+namespace {
+
+constexpr uint32_t ANY = UINT32_MAX;
+constexpr size_t OUTPUT_CHUNK = 1 << 20;
+constexpr size_t TOP_KILLERS = 10;
+
+struct Filter {
+    uint32_t fromTick = 0;
+    uint32_t toTick = UINT32_MAX;
+    uint32_t killerKind = ANY;
+    uint32_t victimKind = ANY;
+    uint32_t id = ANY;
+
+    bool matches(const BattleLogRecord& r) const {
+        return r.tick >= fromTick && r.tick <= toTick &&
+               (killerKind == ANY || r.killerKind == killerKind) &&
+               (victimKind == ANY || r.victimKind == victimKind) &&
+               (id == ANY || r.killerId == id || r.victimId == id);
+    }
+};
+
+struct Stats {
+    uint64_t matched = 0;
+    uint32_t firstTick = UINT32_MAX;
+    uint32_t lastTick = 0;
+    uint64_t kills[NPC_KIND_COUNT][NPC_KIND_COUNT] = {};
+    std::unordered_map<uint32_t, uint64_t> killsById;
+
+    void add(const BattleLogRecord& r) {
+        matched++;
+        firstTick = std::min(firstTick, r.tick);
+        lastTick = std::max(lastTick, r.tick);
+        if (r.killerKind < NPC_KIND_COUNT && r.victimKind < NPC_KIND_COUNT) {
+            kills[r.killerKind][r.victimKind]++;
+        }
+        killsById[r.killerId]++;
+    }
+};
+
+const char* kindLabel(uint8_t kind) {
+    return kind < NPC_KIND_COUNT ? NPC_KIND_NAMES[kind] : "?";
+}
+
+bool parseKind(std::string_view text, uint32_t& kind) {
+    for (size_t k = 0; k < NPC_KIND_COUNT; k++) {
+        if (text == NPC_KIND_NAMES[k]) {
+            kind = static_cast<uint32_t>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseNumber(std::string_view text, uint32_t& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+void printUsage() {
+    std::cerr << "Использование: battle_log_dump [параметры] <battle_log.bin>\n"
+              << "  --stats               сводка вместо вывода записей\n"
+              << "  --from-tick N         записи начиная с тика N\n"
+              << "  --to-tick N           записи до тика N включительно\n"
+              << "  --killer-kind ВИД     Knight, Orc или Bear\n"
+              << "  --victim-kind ВИД\n"
+              << "  --id N                NPC с идентификатором N (убийца или жертва)\n"
+              << "  --limit N             вывести не больше N записей\n";
+}
+
+void appendRecord(std::string& out, const BattleLogRecord& r) {
+    char line[160];
+    int size = std::snprintf(line, sizeof(line), "%u\t%lld\t%s#%u\t%s#%u\t%.1f\t%.1f\n",
+                             r.tick, static_cast<long long>(r.timestampNs),
+                             kindLabel(r.killerKind), r.killerId,
+                             kindLabel(r.victimKind), r.victimId, r.x, r.y);
+    out.append(line, static_cast<size_t>(size));
+}
+
+void printStats(const Stats& stats) {
+    std::cout << "Записей: " << stats.matched << "\n";
+    if (stats.matched == 0) return;
+    
+    uint32_t ticks = stats.lastTick - stats.firstTick + 1;
+    std::cout << "Тики: " << stats.firstTick << ".." << stats.lastTick
+              << " (смертей за тик: " << static_cast<double>(stats.matched) / ticks << ")\n";
+    
+    std::cout << "Убийства по видам (убийца -> жертва):\n";
+    for (size_t a = 0; a < NPC_KIND_COUNT; a++) {
+        for (size_t b = 0; b < NPC_KIND_COUNT; b++) {
+            if (stats.kills[a][b] > 0) {
+                std::cout << "  " << NPC_KIND_NAMES[a] << " -> " << NPC_KIND_NAMES[b]
+                          << ": " << stats.kills[a][b] << "\n";
+            }
+        }
+    }
+    
+    std::vector<std::pair<uint32_t, uint64_t>> top(stats.killsById.begin(), stats.killsById.end());
+    size_t shown = std::min(TOP_KILLERS, top.size());
+    std::partial_sort(top.begin(), top.begin() + shown, top.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.second != b.second ? a.second > b.second : a.first < b.first;
+                      });
+    
+    std::cout << "Самые результативные NPC:\n";
+    for (size_t i = 0; i < shown; i++) {
+        std::cout << "  #" << top[i].first << ": " << top[i].second << "\n";
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Filter filter;
+    bool statsMode = false;
+    uint64_t limit = UINT64_MAX;
+    const char* path = nullptr;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = true;
+        
+        if (arg == "--stats") {
+            statsMode = true;
+        } else if (arg == "--from-tick" && hasValue) {
+            ok = parseNumber(argv[++i], filter.fromTick);
+        } else if (arg == "--to-tick" && hasValue) {
+            ok = parseNumber(argv[++i], filter.toTick);
+        } else if (arg == "--killer-kind" && hasValue) {
+            ok = parseKind(argv[++i], filter.killerKind);
+        } else if (arg == "--victim-kind" && hasValue) {
+            ok = parseKind(argv[++i], filter.victimKind);
+        } else if (arg == "--id" && hasValue) {
+            ok = parseNumber(argv[++i], filter.id);
+        } else if (arg == "--limit" && hasValue) {
+            uint32_t value = 0;
+            ok = parseNumber(argv[++i], value);
+            limit = value;
+        } else if (!arg.starts_with("--") && !path) {
+            path = argv[i];
+        } else {
+            ok = false;
+        }
+        
+        if (!ok) {
+            std::cerr << "Неверный параметр: " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+    
+    if (!path) {
+        printUsage();
+        return 2;
+    }
+    
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Не удалось открыть " << path << "\n";
+        return 1;
+    }
+    
+    struct stat info{};
+    ::fstat(fd, &info);
+    size_t fileSize = static_cast<size_t>(info.st_size);
+    
+    if (fileSize < sizeof(BattleLogHeader)) {
+        std::cerr << "Файл слишком мал для журнала боев\n";
+        ::close(fd);
+        return 1;
+    }
+    
+    void* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Не удалось отобразить файл в память\n";
+        return 1;
+    }
+    ::madvise(mapped, fileSize, MADV_SEQUENTIAL);
+    
+    const auto* bytes = static_cast<const uint8_t*>(mapped);
+    const auto* header = reinterpret_cast<const BattleLogHeader*>(bytes);
+    if (!header->isValid() || header->recordSize != sizeof(BattleLogRecord)) {
+        std::cerr << "Неизвестный формат или версия журнала\n";
+        ::munmap(mapped, fileSize);
+        return 1;
+    }
+    
+    // Заголовок мог не обновиться при аварийном завершении: верим размеру файла не больше
+    uint64_t available = (fileSize - sizeof(BattleLogHeader)) / sizeof(BattleLogRecord);
+    uint64_t count = std::min(header->recordCount, available);
+    const auto* records = reinterpret_cast<const BattleLogRecord*>(bytes + sizeof(BattleLogHeader));
+    
+    Stats stats;
+    std::string out;
+    out.reserve(OUTPUT_CHUNK + 256);
+    uint64_t printed = 0;
+    
+    for (uint64_t i = 0; i < count && printed < limit; i++) {
+        const BattleLogRecord& record = records[i];
+        if (!filter.matches(record)) continue;
+        
+        if (statsMode) {
+            stats.add(record);
+            continue;
+        }
+        
+        appendRecord(out, record);
+        printed++;
+        if (out.size() >= OUTPUT_CHUNK) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+    
+    if (statsMode) {
+        printStats(stats);
+    } else {
+        std::fwrite(out.data(), 1, out.size(), stdout);
+    }
+    
+    ::munmap(mapped, fileSize);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// Формат бинарного журнала боев: заголовок и записи фиксированного размера.
+// Порядок байт - родной для машины, на которой журнал записан.
+struct BattleLogHeader {
+    static constexpr char MAGIC[8] = {'N', 'P', 'C', 'B', 'L', 'O', 'G', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCount;   // количество полностью записанных записей
+    int64_t startTimeNs;    // начало первой сессии, system_clock
+
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(magic)) == 0 && version == VERSION;
+    }
+};
+
+// Одна смерть. Идентификаторы NPC - индексы их дескрипторов в мире.
+struct BattleLogRecord {
+    uint32_t tick;
+    uint32_t killerId;
+    uint32_t victimId;
+    uint8_t killerKind;     // NpcKind
+    uint8_t victimKind;
+    uint16_t reserved;
+    int64_t timestampNs;    // system_clock
+    float x, y;             // позиция жертвы
+};
+
+static_assert(sizeof(BattleLogHeader) == 32);
+static_assert(sizeof(BattleLogRecord) == 32);
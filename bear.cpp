@@ -2,14 +2,12 @@
 #include "knight.h"
 #include "orc.h"
 
-Bear::Bear(const std::string& n, double xPos, double yPos) : NPC(n, xPos, yPos, 5.0) {}
+Bear::Bear(NameId n, double xPos, double yPos) : NPC(n, xPos, yPos, 5.0, NpcKind::Bear) {}
 
-std::string Bear::getType() const {
-    return "Bear";
-}
+Bear::Bear(std::string_view n, double xPos, double yPos) : NPC(n, xPos, yPos, 5.0, NpcKind::Bear) {}
 
-bool Bear::canDefeat(const NPC& other) const {
-    return other.getType() == "Knight";
+std::string_view Bear::getType() const {
+    return "Bear";
 }
 
 void Bear::accept(BattleVisitor& visitor) {
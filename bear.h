@@ -4,10 +4,10 @@
 
 class Bear : public NPC {
 public:
-    Bear(const std::string& n, double xPos, double yPos);
+    Bear(NameId n, double xPos, double yPos);
+    Bear(std::string_view n, double xPos, double yPos);
     
-    std::string getType() const override;
-    bool canDefeat(const NPC& other) const override;
+    std::string_view getType() const override;
     
     void accept(BattleVisitor& visitor) override;
 };
\ No newline at end of file
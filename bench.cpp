@@ -0,0 +1,501 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "npc.h"
+#include "factory.h"
+#include "npc_store.h"
+#include "npc_registry.h"
+#include "spatial_grid.h"
+#include "visitor.h"
+#include "observer.h"
+#include "fight_queue.h"
+#include "thread_pool.h"
+#include "map_renderer.h"
+#include "game_manager.h"
+#include "scenario_loader.h"
+#include "neighbour_lists.h"
+#include "batch_mover.h"
+#include "counter_rng.h"
+#include "fight_resolver.h"
+
+// Микробенчмарки горячих путей. Размер мира N меняется от 100 до 1M при
+// постоянной плотности (как в игре: 50 NPC на 100x100 м), число потоков -
+// от 1 до MAX_THREADS. Потоки делят N между собой, поэтому рост числа
+// потоков при том же N показывает масштабирование, а не рост работы.
+// По умолчанию результаты дополнительно пишутся в bench_results.json.
+
+namespace {
+
+constexpr int64_t MIN_N = 100;
+constexpr int64_t MAX_N = 1'000'000;
+constexpr int MAX_THREADS = 8;
+constexpr double DENSITY = 50.0 / (100.0 * 100.0);
+constexpr double FIGHT_RANGE = 10.0;
+constexpr const char* TYPES[] = {"Knight", "Orc", "Bear"};
+
+double sideFor(size_t count) {
+    return std::max(100.0, std::sqrt(count / DENSITY));
+}
+
+// Мир из N NPC, зарегистрированных в хранилище и реестре
+struct BenchWorld {
+    size_t count;
+    double side;
+    std::vector<std::unique_ptr<NPC>> npcs;
+    NpcStore store;
+    NpcRegistry registry;
+
+    explicit BenchWorld(size_t n) : count(n), side(sideFor(n)) {
+        std::mt19937_64 gen(42);
+        std::uniform_real_distribution<> pos(1.0, side - 1.0);
+
+        npcs.reserve(n);
+        store.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            npcs.push_back(NPCFactory::createNPC(TYPES[i % 3], "N" + std::to_string(i), pos(gen), pos(gen), side, side));
+            store.add(*npcs.back());
+            registry.add(npcs.back().get());
+        }
+    }
+};
+
+// Один мир за раз, чтобы прогон до 1M не держал в памяти все размеры сразу.
+// Вызывается только потоком 0 до начала цикла замера.
+BenchWorld& worldFor(size_t n) {
+    static std::unique_ptr<BenchWorld> world;
+    if (!world || world->count != n) {
+        world.reset();
+        world = std::make_unique<BenchWorld>(n);
+    }
+    return *world;
+}
+
+// Доля [begin, end) работы потока
+std::pair<size_t, size_t> sliceFor(const benchmark::State& state, size_t count) {
+    size_t threads = static_cast<size_t>(state.threads());
+    size_t index = static_cast<size_t>(state.thread_index());
+    return {count * index / threads, count * (index + 1) / threads};
+}
+
+// Перенаправляет stdout в /dev/null, пока жив объект
+class StdoutSilencer {
+private:
+    int saved;
+
+public:
+    StdoutSilencer() {
+        std::cout.flush();
+        std::fflush(stdout);
+        saved = ::dup(STDOUT_FILENO);
+        int devNull = ::open("/dev/null", O_WRONLY);
+        ::dup2(devNull, STDOUT_FILENO);
+        ::close(devNull);
+    }
+
+    ~StdoutSilencer() {
+        std::cout.flush();
+        std::fflush(stdout);
+        ::dup2(saved, STDOUT_FILENO);
+        ::close(saved);
+    }
+};
+
+}
+
+static void BM_DistanceTo(benchmark::State& state) {
+    static BenchWorld* world;
+    if (state.thread_index() == 0) world = &worldFor(state.range(0));
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, world->count);
+        double sum = 0.0;
+        for (size_t i = begin + 1; i < end; i++) {
+            sum += world->npcs[i]->distanceTo(*world->npcs[i - 1]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    auto [begin, end] = sliceFor(state, world->count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+}
+BENCHMARK(BM_DistanceTo)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+static void BM_Move(benchmark::State& state) {
+    static BenchWorld* world;
+    if (state.thread_index() == 0) world = &worldFor(state.range(0));
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, world->count);
+        for (size_t i = begin; i < end; i++) {
+            world->npcs[i]->move(world->side, world->side);
+        }
+    }
+
+    auto [begin, end] = sliceFor(state, world->count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+}
+BENCHMARK(BM_Move)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+// Тот же шаг, но одним проходом BatchMover по массивам хранилища.
+// Сравнивать с BM_Move при одном потоке.
+static void BM_BatchMove(benchmark::State& state) {
+    BenchWorld& world = worldFor(state.range(0));
+    BatchMover mover;
+    CounterRng rng(1);
+
+    uint32_t tick = 0;
+    for (auto _ : state) {
+        mover.moveAll(world.store, rng, ++tick, world.side, world.side);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(world.count));
+    state.SetLabel(mover.getKernel() == BatchMover::Kernel::Avx2 ? "AVX2" : "scalar");
+}
+BENCHMARK(BM_BatchMove)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->UseRealTime();
+
+// Поиск боев для каждого NPC через BattleVisitor::visit. Сам visit не
+// потокобезопасен, поэтому параметр потоков - размер пула для visitAll.
+static void BM_Visit(benchmark::State& state) {
+    BenchWorld& world = worldFor(state.range(0));
+    size_t threads = static_cast<size_t>(state.range(1));
+
+    SpatialGrid grid(world.side, world.side, FIGHT_RANGE);
+    grid.rebuild(world.store);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(world.count * 2, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(FIGHT_RANGE, world.store, grid, observers, queue);
+    ThreadPool pool(threads);
+    std::vector<FightTask> drained(queue.capacity());
+
+    uint32_t tick = 0;
+    for (auto _ : state) {
+        visitor.beginTick(++tick);
+        if (threads == 1) {
+            for (size_t i = 0; i < world.count; i++) {
+                visitor.visit(static_cast<uint32_t>(i));
+            }
+            visitor.flush();
+        } else {
+            visitor.visitAll(pool);
+        }
+
+        state.PauseTiming();
+        while (queue.popBatch(drained.data(), drained.size()) > 0) {}
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(world.count));
+}
+BENCHMARK(BM_Visit)->ArgsProduct({benchmark::CreateRange(MIN_N, MAX_N, 10), benchmark::CreateRange(1, MAX_THREADS, 2)})
+    ->ArgNames({"n", "pool"})->UseRealTime();
+
+// Шаг тика без разрешения боев: движение BatchMover, перестройка сетки и
+// поиск пар, все на пуле заданного размера
+static void BM_MovementTick(benchmark::State& state) {
+    BenchWorld& world = worldFor(state.range(0));
+    size_t threads = static_cast<size_t>(state.range(1));
+
+    SpatialGrid grid(world.side, world.side, FIGHT_RANGE);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(world.count * 2, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(FIGHT_RANGE, world.store, grid, observers, queue);
+    ThreadPool pool(threads);
+    BatchMover mover;
+    CounterRng rng(11);
+    std::vector<FightTask> drained(queue.capacity());
+
+    uint32_t tick = 0;
+    for (auto _ : state) {
+        tick++;
+        mover.moveAll(world.store, rng, tick, world.side, world.side, pool);
+        grid.rebuild(world.store);
+        visitor.beginTick(tick);
+        visitor.visitAll(pool);
+
+        state.PauseTiming();
+        while (queue.popBatch(drained.data(), drained.size()) > 0) {}
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(world.count));
+}
+BENCHMARK(BM_MovementTick)
+    ->ArgsProduct({benchmark::CreateRange(MIN_N, MAX_N, 10), benchmark::CreateRange(1, MAX_THREADS, 2)})
+    ->ArgNames({"n", "pool"})->UseRealTime();
+
+// Поиск боев по спискам соседей с запасом 5 м в медленно движущемся мире
+// (до 0.5 м за тик): в замер входят prepare, перестройка сетки, когда она
+// нужна, и visitAll. Сравнивать с BM_Visit плюс перестройка сетки.
+static void BM_VisitNeighbourLists(benchmark::State& state) {
+    BenchWorld& world = worldFor(state.range(0));
+    size_t threads = static_cast<size_t>(state.range(1));
+
+    SpatialGrid grid(world.side, world.side, FIGHT_RANGE);
+    NeighbourLists lists(FIGHT_RANGE, 5.0);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(world.count * 2, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(FIGHT_RANGE, world.store, grid, observers, queue);
+    visitor.setNeighbourLists(&lists);
+    ThreadPool pool(threads);
+    std::vector<FightTask> drained(queue.capacity());
+    std::mt19937_64 gen(7);
+    std::uniform_real_distribution<> jitter(-0.35, 0.35);
+
+    uint32_t tick = 0;
+    size_t rebuilds = 0;
+    for (auto _ : state) {
+        if (lists.prepare(world.store) > 0) {
+            grid.rebuild(world.store);
+        }
+        visitor.beginTick(++tick);
+        visitor.visitAll(pool);
+        rebuilds += lists.lastRebuilds();
+
+        state.PauseTiming();
+        while (queue.popBatch(drained.data(), drained.size()) > 0) {}
+        for (size_t i = 0; i < world.count; i++) {
+            world.store.x[i] = std::clamp(world.store.x[i] + jitter(gen), 0.0, world.side);
+            world.store.y[i] = std::clamp(world.store.y[i] + jitter(gen), 0.0, world.side);
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(world.count));
+    state.counters["rebuilds/tick"] = static_cast<double>(rebuilds) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_VisitNeighbourLists)
+    ->ArgsProduct({benchmark::CreateRange(MIN_N, MAX_N, 10), benchmark::CreateRange(1, MAX_THREADS, 2)})
+    ->ArgNames({"n", "pool"})->UseRealTime();
+
+// Разрешение всех пар одного тика, найденных в мире из N NPC. Параметр
+// потоков - размер пула резолвера. Перед каждым прогоном NPC оживают,
+// чтобы каждый раз разрешался один и тот же набор боев.
+static void BM_FightResolve(benchmark::State& state) {
+    BenchWorld& world = worldFor(state.range(0));
+    size_t threads = static_cast<size_t>(state.range(1));
+
+    SpatialGrid grid(world.side, world.side, FIGHT_RANGE);
+    grid.rebuild(world.store);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(world.count * 2, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(FIGHT_RANGE, world.store, grid, observers, queue);
+    ThreadPool pool(threads);
+    FightResolver resolver(pool, FIGHT_RANGE);
+    CounterRng rng(5);
+
+    const uint32_t tick = 1;
+    visitor.beginTick(tick);
+    visitor.visitAll(pool);
+    std::vector<FightTask> tasks(queue.depth());
+    tasks.resize(queue.popBatch(tasks.data(), tasks.size()));
+
+    size_t resolved = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::fill(world.store.alive.begin(), world.store.alive.end(), 1);
+        state.ResumeTiming();
+
+        resolved = resolver.resolve(tasks.data(), tasks.size(), world.registry, visitor, rng, tick);
+    }
+    std::fill(world.store.alive.begin(), world.store.alive.end(), 1);
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tasks.size()));
+    state.counters["fights"] = static_cast<double>(resolved);
+    state.counters["colors"] = static_cast<double>(resolver.getColorCount());
+}
+BENCHMARK(BM_FightResolve)
+    ->ArgsProduct({benchmark::CreateRange(MIN_N, MAX_N, 10), benchmark::CreateRange(1, MAX_THREADS, 2)})
+    ->ArgNames({"n", "pool"})->UseRealTime();
+
+// Потоки попеременно кладут и забирают пачки задач из общей очереди
+static void BM_FightQueuePushPop(benchmark::State& state) {
+    constexpr size_t BATCH = 256;
+    static std::unique_ptr<FightQueue> queue;
+    if (state.thread_index() == 0) {
+        queue = std::make_unique<FightQueue>(BATCH * MAX_THREADS * 2, BackpressurePolicy::Block);
+    }
+
+    std::vector<FightTask> batch(BATCH);
+    for (size_t i = 0; i < BATCH; i++) {
+        batch[i] = FightTask{NpcHandle{static_cast<uint32_t>(i), 0}, NpcHandle{static_cast<uint32_t>(i + 1), 0}, 1};
+    }
+    std::vector<FightTask> out(BATCH);
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, state.range(0));
+        for (size_t done = begin; done < end; done += BATCH) {
+            size_t count = std::min(BATCH, end - done);
+            queue->pushBatch(batch.data(), count);
+
+            // popBatch может вернуть меньше, пока соседний поток не дописал
+            // ячейку; забираем ровно столько, сколько положили, иначе
+            // очередь с политикой Block заполнится и все потоки встанут
+            for (size_t popped = 0; popped < count; ) {
+                popped += queue->popBatch(out.data(), count - popped);
+            }
+        }
+    }
+
+    auto [begin, end] = sliceFor(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+    if (state.thread_index() == 0) state.counters["drops"] = static_cast<double>(queue->dropped());
+}
+BENCHMARK(BM_FightQueuePushPop)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+static void BM_CreateNPC(benchmark::State& state) {
+    std::mt19937_64 gen(7 + state.thread_index());
+    std::uniform_real_distribution<> pos(1.0, 99.0);
+    std::vector<std::unique_ptr<NPC>> created;
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, state.range(0));
+        created.clear();
+        created.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            created.push_back(NPCFactory::createNPC(TYPES[i % 3], "NPC", pos(gen), pos(gen)));
+        }
+        benchmark::DoNotOptimize(created.data());
+    }
+
+    auto [begin, end] = sliceFor(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+}
+BENCHMARK(BM_CreateNPC)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+// То же создание, но объект и блок управления shared_ptr - одним куском из арены
+static void BM_CreateNPCArena(benchmark::State& state) {
+    std::mt19937_64 gen(7 + state.thread_index());
+    std::uniform_real_distribution<> pos(1.0, 99.0);
+    std::vector<std::shared_ptr<NPC>> created;
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, state.range(0));
+        state.PauseTiming();
+        created.clear();
+        auto arena = std::make_unique<SlabArena>();
+        state.ResumeTiming();
+
+        arena->reserve((end - begin) * NPCFactory::ARENA_BYTES_PER_NPC);
+        NameId name = NameTable::global().intern("NPC");
+        created.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            created.push_back(NPCFactory::createShared(static_cast<NpcKind>(i % 3), name, pos(gen), pos(gen), *arena));
+        }
+        benchmark::DoNotOptimize(created.data());
+
+        state.PauseTiming();
+        created.clear();
+        arena.reset();
+        state.ResumeTiming();
+    }
+
+    auto [begin, end] = sliceFor(state, state.range(0));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+}
+BENCHMARK(BM_CreateNPCArena)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+static void BM_LoadFromString(benchmark::State& state) {
+    static std::vector<std::string> lines;
+    if (state.thread_index() == 0) {
+        std::mt19937_64 gen(9);
+        std::uniform_real_distribution<> pos(1.0, 99.0);
+        lines.clear();
+        for (int64_t i = 0; i < state.range(0); i++) {
+            lines.push_back(std::string(TYPES[i % 3]) + " NPC_" + std::to_string(i) + " " +
+                            std::to_string(pos(gen)) + " " + std::to_string(pos(gen)));
+        }
+    }
+
+    for (auto _ : state) {
+        auto [begin, end] = sliceFor(state, lines.size());
+        for (size_t i = begin; i < end; i++) {
+            auto npc = NPCFactory::loadFromString(lines[i]);
+            benchmark::DoNotOptimize(npc.get());
+        }
+    }
+
+    auto [begin, end] = sliceFor(state, lines.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(end - begin));
+}
+BENCHMARK(BM_LoadFromString)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+// Тот же текст, что у BM_LoadFromString, одним буфером через массовый загрузчик.
+// Параметр потоков - размер пула.
+static void BM_ParseScenario(benchmark::State& state) {
+    std::mt19937_64 gen(9);
+    std::uniform_real_distribution<> pos(1.0, 99.0);
+    std::string text;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        text += std::string(TYPES[i % 3]) + " NPC_" + std::to_string(i) + " " +
+                std::to_string(pos(gen)) + " " + std::to_string(pos(gen)) + "\n";
+    }
+    ThreadPool pool(static_cast<size_t>(state.range(1)));
+
+    for (auto _ : state) {
+        ScenarioData data = ScenarioLoader::parseText(text, 100.0, 100.0, pool);
+        benchmark::DoNotOptimize(data.x.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_ParseScenario)->ArgsProduct({benchmark::CreateRange(MIN_N, MAX_N, 10), benchmark::CreateRange(1, MAX_THREADS, 2)})
+    ->ArgNames({"n", "pool"})->UseRealTime();
+
+// Полный printMap игры с N NPC; вывод уходит в /dev/null. Потоки
+// соревнуются за отрисовку так же, как это делали бы несколько зрителей.
+static void BM_PrintMap(benchmark::State& state) {
+    static std::unique_ptr<StdoutSilencer> silencer;
+    static std::unique_ptr<GameManager> game;
+    if (state.thread_index() == 0) {
+        silencer = std::make_unique<StdoutSilencer>();
+        SimulationConfig config;
+        config.npcCount = static_cast<int>(state.range(0));
+        config.mapWidth = config.mapHeight = sideFor(config.npcCount);
+        config.headless = true;
+        config.seed = 1;
+        game = std::make_unique<GameManager>(config);
+    }
+
+    for (auto _ : state) {
+        game->printMap();
+    }
+
+    if (state.thread_index() == 0) {
+        game.reset();
+        silencer.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PrintMap)->RangeMultiplier(10)->Range(MIN_N, MAX_N)->ThreadRange(1, MAX_THREADS)->UseRealTime();
+
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+
+    // Без явного --benchmark_out результаты сохраняются в JSON для сравнения прогонов
+    std::string out = "--benchmark_out=bench_results.json";
+    std::string format = "--benchmark_out_format=json";
+    bool hasOut = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]).starts_with("--benchmark_out=")) hasOut = true;
+    }
+    if (!hasOut) {
+        args.push_back(out.data());
+        args.push_back(format.data());
+    }
+
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "binary_log_observer.h"
+#include "npc.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std::chrono;
+
+static int64_t nowNs() {
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+BinaryLogObserver::BinaryLogObserver(const std::string& fname) : filename(fname), fd(-1),
+    base(nullptr), capacity(0), nextRecord(0), lostFrom(NO_LOSS) {
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    
+    struct stat info{};
+    ::fstat(fd, &info);
+    size_t fileSize = static_cast<size_t>(info.st_size);
+    
+    BattleLogHeader existing{};
+    bool resume = fileSize >= sizeof(BattleLogHeader) &&
+                  ::pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                  existing.isValid() && existing.recordSize == sizeof(BattleLogRecord) &&
+                  sizeof(BattleLogHeader) + existing.recordCount * sizeof(BattleLogRecord) <= fileSize;
+    
+    if (!resume) {
+        // Пустой или чужой файл начинается заново
+        if (::ftruncate(fd, 0) != 0) {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        existing = BattleLogHeader{};
+    }
+    
+    size_t records = std::max<size_t>(INITIAL_CAPACITY, existing.recordCount * 2);
+    if (!remap(records)) {
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    
+    if (!resume) {
+        BattleLogHeader* h = header();
+        std::memcpy(h->magic, BattleLogHeader::MAGIC, sizeof(h->magic));
+        h->version = BattleLogHeader::VERSION;
+        h->recordSize = sizeof(BattleLogRecord);
+        h->recordCount = 0;
+        h->startTimeNs = nowNs();
+    }
+    nextRecord.store(header()->recordCount, std::memory_order_relaxed);
+}
+
+BinaryLogObserver::~BinaryLogObserver() {
+    if (base) {
+        flush();
+        uint64_t count = header()->recordCount;
+        ::munmap(base, sizeof(BattleLogHeader) + capacity * sizeof(BattleLogRecord));
+        
+        // Хвост, зарезервированный под рост, отрезается
+        [[maybe_unused]] int rc = ::ftruncate(fd, sizeof(BattleLogHeader) + count * sizeof(BattleLogRecord));
+    }
+    if (fd >= 0) ::close(fd);
+}
+
+bool BinaryLogObserver::remap(size_t records) {
+    size_t oldBytes = sizeof(BattleLogHeader) + capacity * sizeof(BattleLogRecord);
+    size_t newBytes = sizeof(BattleLogHeader) + records * sizeof(BattleLogRecord);
+    
+    if (::ftruncate(fd, static_cast<off_t>(newBytes)) != 0) return false;
+    
+    void* mapped = base
+        ? ::mremap(base, oldBytes, newBytes, MREMAP_MAYMOVE)
+        : ::mmap(nullptr, newBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return false;
+    
+    base = static_cast<uint8_t*>(mapped);
+    capacity = records;
+    return true;
+}
+
+void BinaryLogObserver::onDeathEvent(const DeathEvent& event) {
+    if (!base || isTruncated()) return;
+    
+    BattleLogRecord record{};
+    record.tick = event.tick;
+    record.killerId = event.killer.getRngId();
+    record.victimId = event.victim.getRngId();
+    record.killerKind = static_cast<uint8_t>(event.killer.getKind());
+    record.victimKind = static_cast<uint8_t>(event.victim.getKind());
+    record.timestampNs = nowNs();
+    record.x = static_cast<float>(event.victim.getX());
+    record.y = static_cast<float>(event.victim.getY());
+    
+    uint64_t index = nextRecord.fetch_add(1, std::memory_order_relaxed);
+    
+    {
+        std::shared_lock lock(mapMutex);
+        if (index < capacity) {
+            records()[index] = record;
+            return;
+        }
+    }
+    
+    std::unique_lock lock(mapMutex);
+    while (index >= capacity) {
+        if (!remap(capacity * 2)) {
+            // Места нет: запись теряется, а счетчик откатывать нельзя из-за
+            // параллельных писателей. Журнал обрывается на первом пустом слоте,
+            // даже если позже файл все-таки вырастет.
+            if (index < lostFrom.load(std::memory_order_relaxed)) {
+                lostFrom.store(index, std::memory_order_relaxed);
+            }
+            return;
+        }
+    }
+    records()[index] = record;
+}
+
+void BinaryLogObserver::flush() {
+    if (!base) return;
+    
+    std::unique_lock lock(mapMutex);
+    uint64_t count = std::min<uint64_t>(recordCount(), capacity);
+    header()->recordCount = count;
+    ::msync(base, sizeof(BattleLogHeader), MS_ASYNC);
+}
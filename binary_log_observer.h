@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <shared_mutex>
+#include <cstdint>
+#include <cstddef>
+#include "observer.h"
+#include "battle_log_format.h"
+
+// Пишет смерти записями фиксированного размера в отображенный в память файл
+// (формат - battle_log_format.h). Запись не форматирует строк и не делает
+// системных вызовов: место резервируется атомарным счетчиком, а файл
+// растет удвоением. Существующий корректный журнал дописывается.
+class BinaryLogObserver : public DeathObserver {
+private:
+    static constexpr size_t INITIAL_CAPACITY = 1 << 16;
+    static constexpr uint64_t NO_LOSS = UINT64_MAX;
+
+    std::string filename;
+    int fd;
+    std::shared_mutex mapMutex;
+    uint8_t* base;
+    size_t capacity;
+    std::atomic<uint64_t> nextRecord;
+    // Первый слот, оставшийся пустым из-за неудачного роста файла. Записи
+    // с него и дальше в журнал не попадают, чтобы нули не читались как смерти.
+    std::atomic<uint64_t> lostFrom;
+
+    bool remap(size_t records);
+    BattleLogHeader* header() const { return reinterpret_cast<BattleLogHeader*>(base); }
+    BattleLogRecord* records() const { return reinterpret_cast<BattleLogRecord*>(base + sizeof(BattleLogHeader)); }
+
+public:
+    explicit BinaryLogObserver(const std::string& filename);
+    ~BinaryLogObserver();
+
+    BinaryLogObserver(const BinaryLogObserver&) = delete;
+    BinaryLogObserver& operator=(const BinaryLogObserver&) = delete;
+
+    // Текст без идентификаторов и позиций в бинарный журнал не попадает
+    void onDeath(std::string_view, std::string_view) override {}
+    void onDeathEvent(const DeathEvent& event) override;
+
+    // Фиксирует количество записей в заголовке. Вызывается, когда
+    // новых событий не поступает (например, после остановки потоков).
+    void flush() override;
+
+    bool isOpen() const { return base != nullptr; }
+    uint64_t recordCount() const {
+        return std::min(nextRecord.load(std::memory_order_relaxed), lostFrom.load(std::memory_order_relaxed));
+    }
+    bool isTruncated() const { return lostFrom.load(std::memory_order_relaxed) != NO_LOSS; }
+};
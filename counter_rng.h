@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+enum class RngPurpose : uint32_t {
+    MoveDirection,
+    MoveDistance,
+    AttackDice,
+    DefenseDice,
+};
+
+// Генератор на основе счетчика (Squares, B. Widynski): каждое число -
+// чистая функция от (seed, id NPC, тик, назначение, поток), поэтому
+// генератор не хранит состояния и безопасен для параллельного доступа.
+class CounterRng {
+private:
+    uint64_t seed;
+
+    static uint64_t splitmix64(uint64_t value) {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    static uint64_t squares64(uint64_t counter, uint64_t key) {
+        uint64_t x, y, z, t;
+        y = x = counter * key;
+        z = y + key;
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        t = x = x * x + z; x = (x >> 32) | (x << 32);
+        return t ^ ((x * x + y) >> 32);
+    }
+
+    uint64_t key(RngPurpose purpose, uint32_t stream) const {
+        uint64_t streamId = (static_cast<uint64_t>(purpose) << 32) | stream;
+        return splitmix64(seed ^ splitmix64(streamId)) | 1;
+    }
+
+public:
+    explicit CounterRng(uint64_t worldSeed = 0) : seed(worldSeed) {}
+
+    uint64_t getSeed() const { return seed; }
+
+    uint64_t next(uint32_t id, uint32_t tick, RngPurpose purpose, uint32_t stream = 0) const {
+        uint64_t counter = (static_cast<uint64_t>(id) << 32) | tick;
+        return squares64(counter, key(purpose, stream));
+    }
+
+    // Равномерно в [0, 1)
+    double uniform(uint32_t id, uint32_t tick, RngPurpose purpose, uint32_t stream = 0) const {
+        return static_cast<double>(next(id, tick, purpose, stream) >> 11) * 0x1.0p-53;
+    }
+
+    // Бросок кубика 1..6
+    int dice(uint32_t id, uint32_t tick, RngPurpose purpose, uint32_t stream = 0) const {
+        uint64_t bits = next(id, tick, purpose, stream) >> 32;
+        return 1 + static_cast<int>((bits * 6) >> 32);
+    }
+};
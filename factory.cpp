@@ -1,8 +1,9 @@
 #include "factory.h"
 #include <iostream>
 
-std::unique_ptr<NPC> NPCFactory::createNPC(const std::string& type, const std::string& name, double x, double y) {
-    if (x <= 0 || x > 500 || y <= 0 || y > 500) {
+std::unique_ptr<NPC> NPCFactory::createNPC(const std::string& type, const std::string& name, double x, double y,
+                                           double maxX, double maxY) {
+    if (x <= 0 || x > maxX || y <= 0 || y > maxY) {
         std::cerr << "Ошибка создания NPC: некорректные координаты " << x << ", " << y << " для " << name << std::endl;
         return nullptr;
     }
@@ -15,6 +16,25 @@ std::unique_ptr<NPC> NPCFactory::createNPC(const std::string& type, const std::s
     return nullptr;
 }
 
+std::unique_ptr<NPC> NPCFactory::createNPC(NpcKind kind, NameId name, double x, double y) {
+    switch (kind) {
+        case NpcKind::Knight: return std::make_unique<Knight>(name, x, y);
+        case NpcKind::Orc: return std::make_unique<Orc>(name, x, y);
+        case NpcKind::Bear: return std::make_unique<Bear>(name, x, y);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<NPC> NPCFactory::createShared(NpcKind kind, NameId name, double x, double y,
+                                             SlabArena& arena) {
+    switch (kind) {
+        case NpcKind::Knight: return std::allocate_shared<Knight>(ArenaAllocator<Knight>(arena), name, x, y);
+        case NpcKind::Orc: return std::allocate_shared<Orc>(ArenaAllocator<Orc>(arena), name, x, y);
+        case NpcKind::Bear: return std::allocate_shared<Bear>(ArenaAllocator<Bear>(arena), name, x, y);
+    }
+    return nullptr;
+}
+
 std::unique_ptr<NPC> NPCFactory::loadFromString(const std::string& data) {
     std::stringstream ss(data);
     std::string type, name;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -8,11 +9,25 @@
 #include "knight.h"
 #include "orc.h"
 #include "bear.h"
+#include "slab_arena.h"
 
 class NPCFactory {
 public:
-    static std::unique_ptr<NPC> createNPC(const std::string& type, const std::string& name, double x, double y);
+    // Граница координат по умолчанию; мир большего размера передает свою
+    static constexpr double DEFAULT_MAX_COORDINATE = 500.0;
+    
+    static std::unique_ptr<NPC> createNPC(const std::string& type, const std::string& name, double x, double y,
+                                          double maxX = DEFAULT_MAX_COORDINATE, double maxY = DEFAULT_MAX_COORDINATE);
+    // Без проверки координат: для загрузчиков, которые проверили их сами
+    static std::unique_ptr<NPC> createNPC(NpcKind kind, NameId name, double x, double y);
     static std::unique_ptr<NPC> loadFromString(const std::string& data);
+    
+    // NPC и блок управления shared_ptr - одним куском из арены; арена
+    // должна пережить все созданные так объекты
+    static std::shared_ptr<NPC> createShared(NpcKind kind, NameId name, double x, double y, SlabArena& arena);
+    
+    // Оценка места в арене на одного NPC из createShared - для SlabArena::reserve
+    static constexpr size_t ARENA_BYTES_PER_NPC = std::max({sizeof(Knight), sizeof(Orc), sizeof(Bear)}) + 32;
 };
 
 
@@ -0,0 +1,64 @@
+#include "fight_queue.h"
+#include <thread>
+
+FightQueue::FightQueue(size_t capacity, BackpressurePolicy backpressure) : ring(capacity), policy(backpressure),
+    pushedCount(0), droppedCount(0), signal(0), closed(false) {}
+
+size_t FightQueue::pushBatch(const FightTask* tasks, size_t count) {
+    size_t added = 0;
+    uint64_t drops = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        bool pushed;
+        while (!(pushed = ring.tryPush(tasks[i]))) {
+            if (policy == BackpressurePolicy::DropNewest || isClosed()) {
+                drops++;
+                break;
+            }
+            
+            if (policy == BackpressurePolicy::DropOldest) {
+                FightTask oldest;
+                if (ring.tryPop(oldest)) drops++;
+            } else {
+                // Будим потребителя: он мог уснуть до начала этой пачки
+                signal.fetch_add(1, std::memory_order_release);
+                signal.notify_all();
+                std::this_thread::yield();
+            }
+        }
+        if (pushed) added++;
+    }
+    
+    pushedCount.fetch_add(added, std::memory_order_relaxed);
+    if (drops) droppedCount.fetch_add(drops, std::memory_order_relaxed);
+    
+    if (added > 0) {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+    }
+    return added;
+}
+
+size_t FightQueue::popBatch(FightTask* tasks, size_t maxCount) {
+    size_t count = 0;
+    while (count < maxCount && ring.tryPop(tasks[count])) {
+        count++;
+    }
+    return count;
+}
+
+void FightQueue::waitForTasks() {
+    uint32_t seen = signal.load(std::memory_order_acquire);
+    if (depth() > 0 || isClosed()) return;
+    signal.wait(seen, std::memory_order_acquire);
+}
+
+void FightQueue::close() {
+    closed.store(true, std::memory_order_release);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_all();
+}
+
+void FightQueue::open() {
+    closed.store(false, std::memory_order_release);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "npc_handle.h"
+#include "mpmc_ring.h"
+
+struct FightTask {
+    NpcHandle attacker;
+    NpcHandle defender;
+    uint32_t tick = 0;
+};
+
+enum class BackpressurePolicy {
+    Block,       // производитель ждет, пока в очереди не появится место
+    DropOldest,  // из очереди выбрасывается самая старая задача
+    DropNewest,  // новая задача отбрасывается: пара будет найдена снова на следующем тике
+};
+
+// Ограниченная lock-free очередь боев поверх MpmcRing: пакетные операции,
+// политика при переполнении, счетчики и ожидание задач без мьютекса.
+class FightQueue {
+private:
+    MpmcRing<FightTask> ring;
+    const BackpressurePolicy policy;
+
+    alignas(64) std::atomic<uint64_t> pushedCount;
+    std::atomic<uint64_t> droppedCount;
+    std::atomic<uint32_t> signal;
+    std::atomic<bool> closed;
+
+public:
+    FightQueue(size_t capacity, BackpressurePolicy backpressure);
+
+    bool tryPop(FightTask& task) { return ring.tryPop(task); }
+
+    // Возвращают количество реально добавленных / извлеченных задач
+    size_t pushBatch(const FightTask* tasks, size_t count);
+    size_t popBatch(FightTask* tasks, size_t maxCount);
+
+    // Блокирует поток, пока очередь пуста и не закрыта
+    void waitForTasks();
+
+    void close();
+    void open();
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return ring.capacity(); }
+    size_t depth() const { return ring.depth(); }
+    uint64_t pushed() const { return pushedCount.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    BackpressurePolicy getPolicy() const { return policy; }
+};
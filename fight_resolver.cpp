@@ -0,0 +1,83 @@
+#include "fight_resolver.h"
+#include "npc.h"
+#include "npc_registry.h"
+#include "visitor.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+FightResolver::FightResolver(ThreadPool& workerPool, double range) : pool(workerPool), fightRange(range), colors(MAX_COLORS), colorCount(0), staleDropped(0) {}
+
+size_t FightResolver::partition(const FightTask* tasks, size_t count, const NpcRegistry& registry, uint32_t tick) {
+    for (size_t c = 0; c < colorCount; c++) {
+        colors[c].clear();
+    }
+    overflow.clear();
+    colorCount = 0;
+    
+    if (usedColors.size() < registry.capacity()) {
+        usedColors.resize(registry.capacity(), 0);
+    }
+    
+    size_t accepted = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (tasks[i].tick < tick) {
+            staleDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        
+        NPC* attacker = registry.get(tasks[i].attacker);
+        NPC* defender = registry.get(tasks[i].defender);
+        
+        if (!attacker || !defender || !attacker->isAlive() || !defender->isAlive()) continue;
+        if (!attacker->isInKillingRange(*defender, fightRange)) continue;
+        
+        uint32_t a = tasks[i].attacker.index;
+        uint32_t b = tasks[i].defender.index;
+        uint64_t busy = usedColors[a] | usedColors[b];
+        accepted++;
+        
+        if (busy == UINT64_MAX) {
+            overflow.push_back(Pair{attacker, defender});
+            continue;
+        }
+        
+        size_t color = static_cast<size_t>(__builtin_ctzll(~busy));
+        if (usedColors[a] == 0) touched.push_back(a);
+        if (usedColors[b] == 0) touched.push_back(b);
+        usedColors[a] |= 1ULL << color;
+        usedColors[b] |= 1ULL << color;
+        
+        colors[color].push_back(Pair{attacker, defender});
+        colorCount = std::max(colorCount, color + 1);
+    }
+    
+    for (uint32_t index : touched) {
+        usedColors[index] = 0;
+    }
+    touched.clear();
+    
+    return accepted;
+}
+
+size_t FightResolver::resolve(const FightTask* tasks, size_t count, const NpcRegistry& registry,
+                              BattleVisitor& visitor, const CounterRng& rng, uint32_t tick) {
+    size_t accepted = partition(tasks, count, registry, tick);
+    
+    for (size_t c = 0; c < colorCount; c++) {
+        const std::vector<Pair>& batch = colors[c];
+        size_t chunks = (batch.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        
+        pool.parallelFor(chunks, [&](size_t chunk) {
+            size_t end = std::min(batch.size(), (chunk + 1) * CHUNK_SIZE);
+            for (size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+                visitor.processFight(*batch[i].attacker, *batch[i].defender, rng, tick);
+            }
+        });
+    }
+    
+    for (const Pair& pair : overflow) {
+        visitor.processFight(*pair.attacker, *pair.defender, rng, tick);
+    }
+    
+    return accepted;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "fight_queue.h"
+
+class NPC;
+class NpcRegistry;
+class BattleVisitor;
+class CounterRng;
+class ThreadPool;
+
+// Параллельное разрешение боев одного раунда. Пары жадно раскрашиваются так,
+// чтобы ни один NPC не встречался дважды в одном цвете; пары одного цвета
+// независимы и разрешаются пулом потоков без блокировок, цвета - по очереди.
+class FightResolver {
+private:
+    struct Pair {
+        NPC* attacker;
+        NPC* defender;
+    };
+
+    static constexpr size_t MAX_COLORS = 64;
+    static constexpr size_t CHUNK_SIZE = 128;
+
+    ThreadPool& pool;
+    double fightRange;
+    std::vector<std::vector<Pair>> colors;
+    std::vector<Pair> overflow;
+    std::vector<uint64_t> usedColors;
+    std::vector<uint32_t> touched;
+    size_t colorCount;
+    std::atomic<uint64_t> staleDropped;
+
+    size_t partition(const FightTask* tasks, size_t count, const NpcRegistry& registry, uint32_t tick);
+
+public:
+    // fightRange - та же дистанция, по которой пары искались
+    FightResolver(ThreadPool& workerPool, double range);
+
+    // Возвращает количество разрешенных боев. Задачи прошлых тиков
+    // отбрасываются без обращения к NPC.
+    size_t resolve(const FightTask* tasks, size_t count, const NpcRegistry& registry,
+                   BattleVisitor& visitor, const CounterRng& rng, uint32_t tick);
+
+    size_t getColorCount() const { return colorCount; }
+    uint64_t getStaleDropped() const { return staleDropped.load(std::memory_order_relaxed); }
+};
@@ -1,40 +1,107 @@
 #include "game_manager.h"
+#include "tracer.h"
+#include "scenario_loader.h"
 #include <iostream>
 #include <chrono>
 #include <random>
 #include <iomanip>
 #include <algorithm>
-
-using namespace std::chrono_literals;
+#include <unistd.h>
+#include <sstream>
+#include <stdexcept>
 
 std::mutex GameManager::coutMutex;
 
 void GameManager::initializeVisitor() {
     battleVisitor = std::make_unique<BattleVisitor>(
-        10.0,
-        npcs,
+        config.fightRange,
+        npcStore,
+        spatialGrid,
         observers,
-        fightQueueMutex,
-        fightQueue,
-        fightQueueCV
+        fightQueue
     );
     
-    safePrint("BattleVisitor инициализирован с дистанцией боя 10м");
+    // Наблюдатели получают смерти в фазе уведомления, а не из потоков пула
+    battleVisitor->setDeferredNotifications(true);
+    
+    // Поиск и разрешение идут в одном потоке: пачку, которая не помещается
+    // в очередь, разрешаем сразу, иначе бои сверх емкости очереди терялись бы
+    battleVisitor->setQueueDrain([this]() {
+        TraceSpan span("resolve");
+        drainFights(currentTick.load());
+    });
+    
+    std::ostringstream range;
+    range << config.fightRange;
+    if (config.neighbourSkin > 0) {
+        neighbourLists = std::make_unique<NeighbourLists>(config.fightRange, config.neighbourSkin);
+        battleVisitor->setNeighbourLists(neighbourLists.get());
+        range << "м, списки соседей с запасом " << config.neighbourSkin;
+    }
+    safePrint("BattleVisitor инициализирован с дистанцией боя " + range.str() + "м");
 }
 
 void GameManager::initializeObservers() {
-    auto consoleObs = std::make_shared<ConsoleObserver>();
     auto fileObs = std::make_shared<FileObserver>("battle_log.txt");
+    auto binaryObs = std::make_shared<BinaryLogObserver>("battle_log.bin");
     
-    observers.push_back(consoleObs);
+    // В режиме headless консоль не засоряется сообщениями о каждой смерти
+    if (!config.headless) {
+        observers.push_back(std::make_shared<ConsoleObserver>());
+    }
     observers.push_back(fileObs);
+    observers.push_back(binaryObs);
     
-    safePrint("Observer'ы инициализированы: ConsoleObserver, FileObserver (battle_log.txt)");
+    safePrint(std::string("Observer'ы инициализированы: ") + (config.headless ? "" : "ConsoleObserver, ") +
+              "FileObserver (battle_log.txt), BinaryLogObserver (battle_log.bin)");
+}
+
+
+static SimulationConfig seededConfig(uint64_t worldSeed) {
+    SimulationConfig config;
+    config.seed = worldSeed;
+    return config;
 }
 
+GameManager::GameManager() : GameManager(SimulationConfig{}) {}
+
+GameManager::GameManager(uint64_t worldSeed, BackpressurePolicy backpressure)
+    : GameManager(seededConfig(worldSeed), backpressure) {}
 
-GameManager::GameManager() : isRunning(false), stopRequested(false), fightsProcessed(0) {
-    generateInitialNPCs();
+GameManager::GameManager(const SimulationConfig& simulationConfig, BackpressurePolicy backpressure) : config(simulationConfig),
+    npcArena(SlabArena::DEFAULT_BLOCK_SIZE, config.hugePages), removedCount(0),
+    spatialGrid(config.mapWidth, config.mapHeight, config.fightRange),
+    worldRng(config.seed ? *config.seed : std::random_device{}()), currentTick(0),
+    scheduler(config.isThrottled()
+                  ? std::chrono::duration_cast<TickScheduler::Clock::duration>(std::chrono::duration<double>(1.0 / config.tickRate))
+                  : TickScheduler::Clock::duration::zero(),
+              config.overrunPolicy),
+    fightQueue(config.fightQueueCapacity, backpressure),
+    workerPool(config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency())),
+    fightResolver(workerPool, config.fightRange), isRunning(false), stopRequested(false), fightsProcessed(0),
+    mapRenderer(config.mapWidth, config.mapHeight, config.renderCols, config.renderRows, config.renderMode) {
+    // Поиск и разрешение идут в одном потоке, ждать в очереди некому
+    if (backpressure == BackpressurePolicy::Block) {
+        throw std::invalid_argument("Политика Block недоступна: очередь боев разбирается тем же потоком");
+    }
+    config.validate();
+    fightRound.resize(fightQueue.capacity());
+    if (config.metrics) {
+        metrics = std::make_unique<Metrics>();
+    }
+    if (config.scenarioFile.empty()) {
+        generateInitialNPCs();
+    } else {
+        loadScenario();
+    }
+    if (!config.saveScenarioFile.empty()) {
+        if (ScenarioLoader::saveSnapshot(config.saveScenarioFile, npcStore, config.mapWidth, config.mapHeight)) {
+            safePrint("Начальный мир сохранен в " + config.saveScenarioFile);
+        } else {
+            safePrint("Не удалось сохранить мир в " + config.saveScenarioFile);
+        }
+    }
+    snapshots.publish(npcStore, currentTick.load());
     
     initializeObservers();
     initializeVisitor();
@@ -45,42 +112,58 @@ GameManager::~GameManager() {
 }
 
 void GameManager::generateInitialNPCs() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> posDist(1.0, MAP_WIDTH - 1.0);
+    std::mt19937_64 gen(worldRng.getSeed());
+    const double marginX = std::min(1.0, config.mapWidth / 4);
+    const double marginY = std::min(1.0, config.mapHeight / 4);
+    std::uniform_real_distribution<> xDist(marginX, config.mapWidth - marginX);
+    std::uniform_real_distribution<> yDist(marginY, config.mapHeight - marginY);
     std::uniform_int_distribution<> typeDist(0, 2);
     
-    std::vector<std::string> types = {"Knight", "Orc", "Bear"};
-    std::map<std::string, int> typeCount;
+    uint32_t typeCount[NPC_KIND_COUNT] = {};
     
-    for (int i = 0; i < INITIAL_NPC_COUNT; i++) {
-        int typeIndex = typeDist(gen);
-        std::string type = types[typeIndex];
+    npcs.reserve(config.npcCount);
+    npcStore.reserve(config.npcCount);
+    npcRegistry.reserve(config.npcCount);
+    npcArena.reserve(config.npcCount * NPCFactory::ARENA_BYTES_PER_NPC);
+    
+    for (int i = 0; i < config.npcCount; i++) {
+        NpcKind kind = static_cast<NpcKind>(typeDist(gen));
         
-        typeCount[type]++;
-        std::string name = generateRandomName(type, typeCount[type]);
+        // Имя "Рыцарь_12" не строится: текст появится, только если его покажут
+        NameId name = NameId::generated(kind, ++typeCount[static_cast<size_t>(kind)]);
         
-        double x = posDist(gen);
-        double y = posDist(gen);
+        double x = xDist(gen);
+        double y = yDist(gen);
         
-        auto npc = NPCFactory::createNPC(type, name, x, y);
-        if (npc) {
-            npcs.push_back(std::shared_ptr<NPC>(std::move(npc)));
-        }
+        // Координаты уже внутри карты
+        npcs.push_back(NPCFactory::createShared(kind, name, x, y, npcArena));
+        npcStore.add(*npcs.back());
+        npcRegistry.add(npcs.back().get());
     }
     
     safePrint("Сгенерировано " + std::to_string(npcs.size()) + " NPC");
     safePrint("Распределение: " + 
-              std::to_string(typeCount["Knight"]) + " рыцарей, " +
-              std::to_string(typeCount["Orc"]) + " орков, " +
-              std::to_string(typeCount["Bear"]) + " медведей");
+              std::to_string(typeCount[static_cast<size_t>(NpcKind::Knight)]) + " рыцарей, " +
+              std::to_string(typeCount[static_cast<size_t>(NpcKind::Orc)]) + " орков, " +
+              std::to_string(typeCount[static_cast<size_t>(NpcKind::Bear)]) + " медведей");
 }
 
-std::string GameManager::generateRandomName(const std::string& type, int index) {
-    if (type == "Knight") return "Рыцарь_" + std::to_string(index);
-    if (type == "Orc") return "Орк_" + std::to_string(index);
-    if (type == "Bear") return "Медведь_" + std::to_string(index);
-    return "NPC_" + std::to_string(index);
+void GameManager::loadScenario() {
+    auto begin = std::chrono::steady_clock::now();
+    ScenarioData data = ScenarioLoader::load(config.scenarioFile, config.mapWidth, config.mapHeight, workerPool);
+    size_t rejected = data.rejected;
+    for (const auto& error : data.errors) {
+        safePrint("Сценарий " + config.scenarioFile + ", " + error);
+    }
+    
+    ScenarioLoader::populate(std::move(data), npcStore, npcRegistry, npcs, workerPool, &npcArena);
+    
+    std::ostringstream elapsed;
+    elapsed << std::fixed << std::setprecision(1)
+            << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    safePrint("Загружено " + std::to_string(npcs.size()) + " NPC из " + config.scenarioFile +
+              " за " + elapsed.str() + " мс" +
+              (rejected ? ", отклонено строк: " + std::to_string(rejected) : ""));
 }
 
 void GameManager::start() {
@@ -88,193 +171,332 @@ void GameManager::start() {
     
     isRunning = true;
     stopRequested = false;
+    fightQueue.open();
+    
+    startTime = std::chrono::steady_clock::now();
+    finishTime = startTime;
+    lastStatsTime = startTime;
+    
+    if (metrics) {
+        Metrics::installDumpSignalHandler();
+    }
+    if (!config.traceFile.empty()) {
+        Tracer::setThreadName("main");
+        Tracer::start();
+    }
     
-    movementThread = std::thread(&GameManager::movementWorker, this);
-    fightThread = std::thread(&GameManager::fightWorker, this);
-    renderThread = std::thread(&GameManager::renderWorker, this);
+    simulationThread = std::thread(&GameManager::simulationWorker, this);
     
+    std::ostringstream duration;
+    duration << config.durationSeconds;
     safePrint("Игра началась! Длительность: " + 
-              std::to_string(GAME_DURATION_SECONDS) + " секунд");
+              (config.durationSeconds > 0 ? duration.str() + " секунд" : "без ограничения") +
+              (config.headless ? " (headless)" : ""));
 }
 
 void GameManager::stop() {
     stopRequested = true;
     isRunning = false;
-    fightQueueCV.notify_all();
+    scheduler.stop();
+    fightQueue.close();
 }
 
 void GameManager::joinAll() {
-    if (movementThread.joinable()) movementThread.join();
-    if (fightThread.joinable()) fightThread.join();
-    if (renderThread.joinable()) renderThread.join();
+    if (simulationThread.joinable()) simulationThread.join();
+    if (startTime != std::chrono::steady_clock::time_point{} && finishTime == startTime) {
+        finishTime = std::chrono::steady_clock::now();
+    }
+    
+    // Журналы асинхронные: дописываем их до итогового вывода
+    for (auto& observer : observers) {
+        observer->flush();
+    }
+    
+    if (!config.traceFile.empty() && Tracer::isActive()) {
+        Tracer::stop();
+        if (Tracer::writeJson(config.traceFile)) {
+            safePrint("Трасса записана в " + config.traceFile + " (событий: " +
+                      std::to_string(Tracer::eventCount()) + ", потеряно: " +
+                      std::to_string(Tracer::droppedCount()) + ")");
+        } else {
+            safePrint("Не удалось записать трассу в " + config.traceFile);
+        }
+    }
 }
 
-void GameManager::movementWorker() {
-    safePrint("Поток движения запущен");
-    while (!stopRequested) {
-        {
-            std::unique_lock lock(npcsMutex);
-            for (auto& npc : npcs) {
-                if (npc->isAlive()) {
-                    npc->move(MAP_WIDTH, MAP_HEIGHT);
-                }
-            }
-        }
-        
-        if (battleVisitor) {
-            std::shared_lock lock(npcsMutex);
-            for (auto& npc : npcs) {
-                if (npc->isAlive()) {
-                    battleVisitor->visit(*npc);
-                }
-            }
-        }
-        
-        std::this_thread::sleep_for(100ms);
+void GameManager::runTicks(uint32_t count) {
+    if (isRunning) return;
+    for (uint32_t i = 0; i < count; i++) {
+        runTick();
     }
+}
+
+void GameManager::simulationWorker() {
+    Tracer::setThreadName("simulation");
+    safePrint("Поток симуляции запущен");
     
-    safePrint("Поток движения остановлен");
+    scheduler.run([this](uint64_t) { return runTick(); });
+    stop();
+    if (metrics) {
+        publishMetrics(currentTick.load(), true);
+    }
+    
+    if (!config.headless) {
+        releaseMap();
+        printMap();
+        printSurvivors();
+    }
+    
+    const TickStats& stats = scheduler.getStats();
+    std::ostringstream latency;
+    latency << std::fixed << std::setprecision(2) << stats.meanMs() << "/" << stats.maxMs();
+    safePrint("Поток симуляции остановлен. Тиков: " + std::to_string(stats.ticks) +
+              ", боев: " + std::to_string(fightsProcessed) +
+              ", тик сред./макс.: " + latency.str() + " мс" +
+              ", опозданий: " + std::to_string(stats.overruns) +
+              ", пропущено слотов: " + std::to_string(stats.skipped));
+    if (!config.headless) safePrint("Игра завершена!");
 }
 
-void GameManager::fightWorker() {
-    safePrint("Поток боев запущен");
+bool GameManager::runTick() {
+    uint32_t tick = currentTick.fetch_add(1) + 1;
     
-    while (!stopRequested || !fightQueue.empty()) {
-        FightTask task;
+    {
+        PhaseTimer tickTimer(metrics.get(), Phase::Tick);
+        TraceSpan tickSpan("tick");
         {
-            std::unique_lock lock(fightQueueMutex);
-            if (fightQueue.empty()) {
-                fightQueueCV.wait_for(lock, 500ms, [this]() { return !fightQueue.empty() || stopRequested; });
-                
-                if (fightQueue.empty() && stopRequested) break;
-                if (fightQueue.empty()) continue;
-            }
-            
-            task = fightQueue.front();
-            fightQueue.pop();
+            PhaseTimer timer(metrics.get(), Phase::Move);
+            TraceSpan span("move");
+            movePhase(tick);
         }
-        
-        if (!task.attacker->isAlive() || !task.defender->isAlive()) {
-            continue;
+        {
+            PhaseTimer timer(metrics.get(), Phase::Detect);
+            TraceSpan span("detect");
+            detectPhase();
         }
-        
-        if (!task.attacker->isInKillingRange(*task.defender)) {
-            continue;
+        {
+            TraceSpan span("resolve");
+            resolvePhase(tick);
         }
-        
         {
-            std::unique_lock lock(npcsMutex);
-            task.attacker->fight(*task.defender);
-            task.defender->fight(*task.attacker);
+            PhaseTimer timer(metrics.get(), Phase::Notify);
+            TraceSpan span("notify");
+            notifyPhase();
+        }
+        {
+            PhaseTimer timer(metrics.get(), Phase::Compact);
+            TraceSpan span("compact");
+            compactPhase();
+        }
+        {
+            TraceSpan span("publish");
+            publishPhase(tick);
+        }
+        // Отрисовка читает кадр, опубликованный после боев этого тика
+        if (!config.headless && tick % config.renderInterval() == 0) {
+            PhaseTimer timer(metrics.get(), Phase::Render);
+            TraceSpan span("render");
+            renderPhase(tick);
         }
-        
-        fightsProcessed++;
     }
     
-    safePrint("Поток боев остановлен. Обработано боев: " + std::to_string(fightsProcessed));
+    if (metrics) {
+        TraceSpan span("metrics");
+        publishMetrics(tick, false);
+    }
+    
+    uint64_t limit = config.tickLimit();
+    return !stopRequested && (limit == 0 || tick < limit);
+}
+
+void GameManager::movePhase(uint32_t tick) {
+    auto lock = tracedLock(npcsMutex, "wait npcsMutex");
+    batchMover.moveAll(npcStore, worldRng, tick, config.mapWidth, config.mapHeight, workerPool);
+    snapshots.publish(npcStore, tick);
 }
 
-void GameManager::renderWorker() {
-    safePrint("Поток отрисовки запущен");
+void GameManager::detectPhase() {
+    // Поиск боев идет по опубликованному кадру, без блокировки мира
+    if (!battleVisitor) return;
     
-    auto startTime = std::chrono::steady_clock::now();
-    while (!stopRequested) {
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(currentTime - startTime).count();
-        
-        if (elapsed >= GAME_DURATION_SECONDS) {
-            stop();
-            break;
-        }
+    auto frame = snapshots.read();
+    // Со списками соседей сетка нужна только тем, чей список устарел
+    size_t rebuilds = neighbourLists ? neighbourLists->prepare(frame->npcs) : frame->npcs.size();
+    if (rebuilds > 0) {
+        spatialGrid.rebuild(frame->npcs);
+    }
+    battleVisitor->setSource(frame->npcs);
+    battleVisitor->beginTick(frame->tick);
+    battleVisitor->visitAll(workerPool);
+    
+    if (metrics) {
+        metrics->setGauge(Gauge::QueueDepth, static_cast<int64_t>(fightQueue.depth()));
+        if (neighbourLists) metrics->setGauge(Gauge::NeighbourRebuilds, static_cast<int64_t>(rebuilds));
+        detectFinished = std::chrono::steady_clock::now();
+    }
+}
 
-        printMap();
-        
-        if (elapsed % 5 == 0) {
-            int aliveCount = 0;
-            {
-                std::shared_lock lock(npcsMutex);
-                for (const auto& npc : npcs) {
-                    if (npc->isAlive()) aliveCount++;
-                }
-            }
-            
-            safePrint("Время: " + std::to_string(elapsed) + 
-                     "с, Выжило: " + std::to_string(aliveCount) +
-                     ", Боев: " + std::to_string(fightsProcessed));
+void GameManager::resolvePhase(uint32_t tick) {
+    if (metrics && fightQueue.depth() > 0) {
+        auto waited = std::chrono::steady_clock::now() - detectFinished;
+        metrics->record(Phase::QueueWait, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+    }
+    drainFights(tick);
+}
+
+void GameManager::drainFights(uint32_t tick) {
+    // Очередь остается буфером между поиском и разрешением. Поиск читает
+    // опубликованный кадр, поэтому разбор посреди поиска его не меняет.
+    size_t count;
+    while ((count = fightQueue.popBatch(fightRound.data(), fightRound.size())) > 0) {
+        PhaseTimer timer(metrics.get(), Phase::Resolve);
+        size_t resolved;
+        {
+            auto lock = tracedLock(npcsMutex, "wait npcsMutex");
+            resolved = fightResolver.resolve(fightRound.data(), count, npcRegistry, *battleVisitor, worldRng, tick);
         }
-        
-        std::this_thread::sleep_for(1s);
+        fightsProcessed += static_cast<int>(resolved);
+    }
+}
+
+void GameManager::notifyPhase() {
+    if (battleVisitor) battleVisitor->notifyPending();
+}
+
+void GameManager::compactPhase() {
+    // Уведомления уже доставлены, и мертвые больше никому не нужны: их слоты
+    // заполняются последними живыми, а индексы реестра освобождаются, так что
+    // старые задачи на бой с ними отбрасываются проверкой поколения
+    auto lock = tracedLock(npcsMutex, "wait npcsMutex");
+    removedNpcs.reserve(npcStore.size());
+    size_t removed = npcStore.removeDead(npcs, removedNpcs);
+    if (removed == 0) return;
+    
+    for (const auto& npc : removedNpcs) {
+        npcRegistry.remove(npc->getHandle());
     }
+    removedNpcs.clear();
+    removedCount += removed;
     
+    // После обвала населения массивы хранилища и владельцев отдают память
+    if (npcs.capacity() > 1024 && npcs.size() * 4 < npcs.capacity()) {
+        npcs.shrink_to_fit();
+        removedNpcs.shrink_to_fit();
+    }
+    npcStore.releaseSpare();
+}
+
+void GameManager::publishPhase(uint32_t tick) {
+    // Кадр после движения нужен только поиску боев. Отрисовка, метрики и
+    // итог игры должны видеть мир после боев и уплотнения - публикуем его.
+    auto lock = tracedLock(npcsMutex, "wait npcsMutex");
+    snapshots.publish(npcStore, tick);
+}
+
+void GameManager::publishMetrics(uint32_t tick, bool final) {
+    metrics->setGauge(Gauge::Alive, static_cast<int64_t>(snapshots.read()->aliveCount));
+    metrics->setGauge(Gauge::Ticks, tick);
+    metrics->setGauge(Gauge::Fights, fightsProcessed.load());
+    metrics->setGauge(Gauge::QueueDropped, static_cast<int64_t>(fightQueue.dropped()));
+    
+    if (Metrics::consumeDumpRequest()) {
+        auto lock = tracedLock(coutMutex, "wait coutMutex");
+        std::cout << metrics->formatTable() << std::flush;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    if (!final && std::chrono::duration<double>(now - lastStatsTime).count() < config.statsIntervalSeconds) {
+        return;
+    }
+    lastStatsTime = now;
+    
+    safePrint(metrics->formatLine());
+    if (!metrics->writePrometheus(config.metricsFile)) {
+        safePrint("Не удалось записать метрики в " + config.metricsFile);
+    }
+}
+
+void GameManager::renderPhase(uint32_t tick) {
     printMap();
-    printSurvivors();
-    safePrint("Игра завершена!");
+    
+    // Статус - раз в пять отрисовок, время - симулированное
+    uint32_t interval = static_cast<uint32_t>(config.renderInterval());
+    if ((tick / interval) % 5 != 0) return;
+    
+    std::ostringstream simulated;
+    simulated << std::fixed << std::setprecision(1) << tick / config.tickRate;
+    size_t aliveCount = snapshots.read()->aliveCount;
+    safePrint("Время: " + simulated.str() + 
+             "с, Выжило: " + std::to_string(aliveCount) +
+             ", Боев: " + std::to_string(fightsProcessed) +
+             ", Очередь: " + std::to_string(fightQueue.depth()) +
+             ", Отброшено: " + std::to_string(fightQueue.dropped()) +
+             ", Опозданий: " + std::to_string(scheduler.getStats().overruns));
 }
 
 void GameManager::safePrint(const std::string& message) {
-    std::lock_guard lock(coutMutex);
+    auto lock = tracedLock(coutMutex, "wait coutMutex");
     std::cout << "[Игра] " << message << std::endl;
 }
 
 void GameManager::printMap() const {
-    const int CELL_SIZE = 10;
-    const int COLS = static_cast<int>(MAP_WIDTH / CELL_SIZE);
-    const int ROWS = static_cast<int>(MAP_HEIGHT / CELL_SIZE);
-    
-    std::lock_guard lock(coutMutex);
-    
-    std::cout << "\n=== КАРТА ПОДЗЕМЕЛЬЯ ===" << std::endl;
-    std::cout << "Масштаб: 1 клетка = " << CELL_SIZE << "x" << CELL_SIZE << " метров" << std::endl;
-    
-    std::vector<std::vector<int>> grid(ROWS, std::vector<int>(COLS, 0));
+    auto renderLock = tracedLock(renderMutex, "wait renderMutex");
     
+    std::string_view image;
     {
-        std::shared_lock lock(npcsMutex);
-        
-        for (const auto& npc : npcs) {
-            if (npc->isAlive()) {
-                int col = static_cast<int>(npc->getX() / CELL_SIZE);
-                int row = static_cast<int>(npc->getY() / CELL_SIZE);
-                
-                if (col >= 0 && col < COLS && row >= 0 && row < ROWS) {
-                    grid[row][col]++;
-                }
-            }
-        }
+        auto frame = snapshots.read();
+        if (!frame.valid()) return;
+        image = mapRenderer.compose(frame->npcs);
     }
+    if (image.empty()) return;
     
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            if (grid[row][col] == 0) {
-                std::cout << ". ";
-            } else if (grid[row][col] < 10) {
-                std::cout << grid[row][col] << " ";
-            } else {
-                std::cout << "* ";
-            }
-        }
-        std::cout << std::endl;
-    }
+    // Кадр уже собран: под coutMutex остается только его запись
+    auto lock = tracedLock(coutMutex, "wait coutMutex");
+    std::cout.flush();
+    MapRenderer::writeFrame(image, STDOUT_FILENO);
+}
+
+void GameManager::releaseMap() {
+    auto renderLock = tracedLock(renderMutex, "wait renderMutex");
+    std::string_view reset = mapRenderer.release();
+    if (reset.empty()) return;
     
-    std::cout << "\nЛегенда: . - пусто, цифра - количество NPC, * - много NPC" << std::endl;
+    auto lock = tracedLock(coutMutex, "wait coutMutex");
+    std::cout.flush();
+    MapRenderer::writeFrame(reset, STDOUT_FILENO);
+}
+
+void GameManager::configureRenderer(int cols, int rows, RenderMode mode) {
+    std::lock_guard renderLock(renderMutex);
+    mapRenderer = MapRenderer(config.mapWidth, config.mapHeight, cols, rows, mode);
+}
+
+SimulationReport GameManager::getReport() const {
+    SimulationReport report;
+    report.ticks = currentTick.load();
+    report.fights = static_cast<uint64_t>(fightsProcessed.load());
+    report.deaths = removedCount + npcStore.size() - npcStore.aliveCount();
+    report.seconds = std::chrono::duration<double>(finishTime - startTime).count();
+    report.tickStats = scheduler.getStats();
+    return report;
 }
 
 void GameManager::printSurvivors() const {
-    std::lock_guard lock(coutMutex);
+    auto lock = tracedLock(coutMutex, "wait coutMutex");
     
     std::cout << "\n=== ВЫЖИВШИЕ NPC ===" << std::endl;
     
     std::map<std::string, int> survivorsByType;
-    std::vector<std::shared_ptr<NPC>> aliveNPCs;
+    std::vector<size_t> aliveNPCs;
     
-    {
-        std::shared_lock lock(npcsMutex);
-        
-        for (const auto& npc : npcs) {
-            if (npc->isAlive()) {
-                survivorsByType[npc->getType()]++;
-                aliveNPCs.push_back(npc);
-            }
+    auto frame = snapshots.read();
+    const NpcStore& world = frame->npcs;
+    
+    for (size_t i = 0; i < world.size(); i++) {
+        if (world.alive[i]) {
+            survivorsByType[kindName(world.type[i])]++;
+            aliveNPCs.push_back(i);
         }
     }
     
@@ -290,10 +512,10 @@ void GameManager::printSurvivors() const {
               << survivorsByType["Bear"] << " медведей" << std::endl;
     
     std::cout << "\nСписок выживших:" << std::endl;
-    for (const auto& npc : aliveNPCs) {
-        std::cout << "- " << npc->getName() << " (" << npc->getType()
+    for (size_t i : aliveNPCs) {
+        std::cout << "- " << NameTable::global().view(world.names[i]) << " (" << kindName(world.type[i])
                   << ") в (" << std::fixed << std::setprecision(1)
-                  << npc->getX() << ", " << npc->getY() << ")" << std::endl;
+                  << world.x[i] << ", " << world.y[i] << ")" << std::endl;
     }
 }
 
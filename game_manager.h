@@ -5,32 +5,71 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
-#include <condition_variable>
-#include <queue>
 #include <atomic>
 #include <map>
+#include <chrono>
 #include "npc.h"
 #include "factory.h"
 #include "visitor.h"
 #include "observer.h"
+#include "binary_log_observer.h"
+#include "spatial_grid.h"
+#include "npc_registry.h"
+#include "npc_store.h"
+#include "batch_mover.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+#include "fight_resolver.h"
+#include "world_snapshot.h"
+#include "map_renderer.h"
+#include "simulation_config.h"
+#include "tick_scheduler.h"
+#include "metrics.h"
+#include "neighbour_lists.h"
+
+// Итоги прогона: сколько тиков, боев и смертей уложилось в wall-clock время
+struct SimulationReport {
+    uint64_t ticks = 0;
+    uint64_t fights = 0;
+    uint64_t deaths = 0;
+    double seconds = 0.0;
+    TickStats tickStats;
+
+    double ticksPerSecond() const { return seconds > 0 ? ticks / seconds : 0.0; }
+    double fightsPerSecond() const { return seconds > 0 ? fights / seconds : 0.0; }
+    double deathsPerSecond() const { return seconds > 0 ? deaths / seconds : 0.0; }
+};
 
 class GameManager {
 private:
-    static constexpr double MAP_WIDTH = 100.0;
-    static constexpr double MAP_HEIGHT = 100.0;
-    static constexpr int GAME_DURATION_SECONDS = 30;
-    static constexpr int INITIAL_NPC_COUNT = 50;
+    const SimulationConfig config;
     
+    NpcStore npcStore;
+    // Арена объявлена раньше npcs: объекты из нее разрушаются первыми
+    SlabArena npcArena;
+    // npcs[i] владеет NPC слота i хранилища; мертвые удаляются в конце тика
     std::vector<std::shared_ptr<NPC>> npcs;
+    std::vector<std::shared_ptr<NPC>> removedNpcs;
+    uint64_t removedCount;
     mutable std::shared_mutex npcsMutex;
+    NpcRegistry npcRegistry;
+    
+    WorldSnapshots snapshots;
+    SpatialGrid spatialGrid;
+    // nullptr без --neighbour-skin
+    std::unique_ptr<NeighbourLists> neighbourLists;
+    BatchMover batchMover;
+    
+    CounterRng worldRng;
+    std::atomic<uint32_t> currentTick;
     
-    std::thread movementThread;
-    std::thread fightThread;
-    std::thread renderThread;
+    std::thread simulationThread;
+    TickScheduler scheduler;
     
-    std::queue<FightTask> fightQueue;
-    std::mutex fightQueueMutex;
-    std::condition_variable fightQueueCV;
+    FightQueue fightQueue;
+    ThreadPool workerPool;
+    FightResolver fightResolver;
+    std::vector<FightTask> fightRound;
 
     std::atomic<bool> isRunning;
     std::atomic<bool> stopRequested;
@@ -41,30 +80,78 @@ private:
     
     std::atomic<int> fightsProcessed;
     
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point finishTime;
+    
+    // nullptr, если метрики выключены: замеры фаз тогда ничего не стоят
+    std::unique_ptr<Metrics> metrics;
+    std::chrono::steady_clock::time_point detectFinished;
+    std::chrono::steady_clock::time_point lastStatsTime;
+    
     static std::mutex coutMutex;
     
-    void movementWorker();
-    void fightWorker();
-    void renderWorker();
+    mutable std::mutex renderMutex;
+    mutable MapRenderer mapRenderer;
+    
+    void simulationWorker();
+    
+    // Фазы одного тика, строго по очереди в потоке симуляции
+    bool runTick();
+    void movePhase(uint32_t tick);
+    void detectPhase();
+    void resolvePhase(uint32_t tick);
+    void drainFights(uint32_t tick);
+    void notifyPhase();
+    void compactPhase();
+    void publishPhase(uint32_t tick);
+    void renderPhase(uint32_t tick);
+    void publishMetrics(uint32_t tick, bool final);
+    // Итоговая карта и выжившие печатаются обычным выводом, без области прокрутки
+    void releaseMap();
     
     void generateInitialNPCs();
-    std::string generateRandomName(const std::string& type, int index);
+    void loadScenario();
     
     void initializeObservers();
     void initializeVisitor();
     
+    
 public:
     GameManager();
+    // BackpressurePolicy::Block - std::invalid_argument: очередь боев
+    // разбирает тот же поток, который ее наполняет
+    explicit GameManager(uint64_t worldSeed, BackpressurePolicy backpressure = BackpressurePolicy::DropOldest);
+    explicit GameManager(const SimulationConfig& simulationConfig,
+                         BackpressurePolicy backpressure = BackpressurePolicy::DropOldest);
     ~GameManager();
     
     void start();
     void stop();
     void joinAll();
     
+    // Выполняет count тиков синхронно в вызывающем потоке, без планировщика
+    // и без отрисовки. Только пока игра не запущена - для тестов и замеров.
+    void runTicks(uint32_t count);
+    
     static void safePrint(const std::string& message);
     void printMap() const;
+    
+    // Разрешение карты в клетках и режим вывода (полный кадр или разности)
+    void configureRenderer(int cols, int rows, RenderMode mode = RenderMode::Full);
     void printSurvivors() const;
     
-    double getMapWidth() const { return MAP_WIDTH; }
-    double getMapHeight() const { return MAP_HEIGHT; }
+    const SimulationConfig& getConfig() const { return config; }
+    double getMapWidth() const { return config.mapWidth; }
+    double getMapHeight() const { return config.mapHeight; }
+    
+    // Действителен после joinAll()
+    SimulationReport getReport() const;
+    
+    Metrics* getMetrics() const { return metrics.get(); }
+    // Занятые слоты хранилища; после уплотнения в конце тика - только живые
+    size_t getStoredNpcCount() const { return npcStore.size(); }
+    uint64_t getWorldSeed() const { return worldRng.getSeed(); }
+    size_t getFightQueueDepth() const { return fightQueue.depth(); }
+    uint64_t getFightQueueDropped() const { return fightQueue.dropped(); }
+    uint64_t getStaleFightsDropped() const { return fightResolver.getStaleDropped(); }
 };
\ No newline at end of file
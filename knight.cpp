@@ -2,14 +2,12 @@
 #include "orc.h"
 #include "bear.h"
 
-Knight::Knight(const std::string& n, double xPos, double yPos) : NPC(n, xPos, yPos, 30.0) {}
+Knight::Knight(NameId n, double xPos, double yPos) : NPC(n, xPos, yPos, 30.0, NpcKind::Knight) {}
 
-std::string Knight::getType() const {
-    return "Knight";
-}
+Knight::Knight(std::string_view n, double xPos, double yPos) : NPC(n, xPos, yPos, 30.0, NpcKind::Knight) {}
 
-bool Knight::canDefeat(const NPC& other) const {
-    return other.getType() == "Orc";
+std::string_view Knight::getType() const {
+    return "Knight";
 }
 
 void Knight::accept(BattleVisitor& visitor) {
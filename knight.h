@@ -4,10 +4,10 @@
 
 class Knight : public NPC {
 public:
-    Knight(const std::string& n, double xPos, double yPos);
+    Knight(NameId n, double xPos, double yPos);
+    Knight(std::string_view n, double xPos, double yPos);
     
-    std::string getType() const override;
-    bool canDefeat(const NPC& other) const override;
+    std::string_view getType() const override;
     
     void accept(BattleVisitor& visitor) override;
 };
\ No newline at end of file
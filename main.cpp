@@ -1,7 +1,21 @@
 #include <iostream>
+#include <iomanip>
 #include "game_manager.h"
 
-int main() {
+int main(int argc, char** argv) {
+    SimulationConfig config;
+    try {
+        config = SimulationConfig::fromArgs(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n\n" << SimulationConfig::usage();
+        return 2;
+    }
+    
+    if (config.showHelp) {
+        std::cout << "Использование: main [параметры]\n" << SimulationConfig::usage();
+        return 0;
+    }
+    
     std::cout << "=== МНОГОПОТОЧНАЯ RPG BALAGUR FATE 3 ===" << std::endl;
     std::cout << "Используемые паттерны:" << std::endl;
     std::cout << "1. Factory - создание NPC разных типов" << std::endl;
@@ -10,20 +24,44 @@ int main() {
     std::cout << "=====================================================" << std::endl;
     
     std::cout << "\nПараметры игры:" << std::endl;
-    std::cout << "- Карта: 100x100 метров" << std::endl;
-    std::cout << "- Начальное количество NPC: 50" << std::endl;
-    std::cout << "- Длительность игры: 30 секунд" << std::endl;
+    std::cout << "- Карта: " << config.mapWidth << "x" << config.mapHeight << " метров" << std::endl;
+    if (config.scenarioFile.empty()) {
+        std::cout << "- Начальное количество NPC: " << config.npcCount << std::endl;
+    } else {
+        std::cout << "- Сценарий: " << config.scenarioFile << std::endl;
+    }
+    if (config.durationSeconds > 0) {
+        std::cout << "- Длительность игры: " << config.durationSeconds << " секунд" << std::endl;
+    }
+    if (config.maxTicks > 0) {
+        std::cout << "- Тиков: " << config.maxTicks << std::endl;
+    }
     std::cout << "- Лог файл: battle_log.txt" << std::endl;
+    std::cout << "- Бинарный лог: battle_log.bin (читается battle_log_dump)" << std::endl;
     
     try {
-        GameManager game;
+        GameManager game(config);
         
-        std::cout << "\nНажмите Enter для начала игры...";
-        std::cin.get();
+        if (!config.headless) {
+            std::cout << "\nНажмите Enter для начала игры...";
+            std::cin.get();
+        }
         
         game.start();
         game.joinAll();
         
+        if (config.headless) {
+            SimulationReport report = game.getReport();
+            std::cout << std::fixed << std::setprecision(1)
+                      << "\n=== ОТЧЕТ HEADLESS ===\n"
+                      << "Время: " << report.seconds << " с, тиков: " << report.ticks
+                      << ", боев: " << report.fights << ", смертей: " << report.deaths << "\n"
+                      << "Тиков/с: " << report.ticksPerSecond()
+                      << ", боев/с: " << report.fightsPerSecond()
+                      << ", смертей/с: " << report.deathsPerSecond() << std::endl;
+            return 0;
+        }
+        
         std::cout << "\nИгра завершена. Результаты сохранены в логах." << std::endl;
         std::cout << "Нажмите Enter для выхода...";
         std::cin.get();
@@ -34,4 +72,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,148 @@
+#include "map_renderer.h"
+#include "npc_store.h"
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <unistd.h>
+
+static constexpr std::string_view LEGEND = "\nЛегенда: . - пусто, цифра - количество NPC, * - много NPC\n";
+
+static void appendNumber(std::string& out, double value) {
+    char digits[32];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, end);
+}
+
+static void appendNumber(std::string& out, int value) {
+    char digits[16];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, end);
+}
+
+MapRenderer::MapRenderer(double mapWidth, double mapHeight, int columns, int rowCount, RenderMode renderMode)
+    : cols(std::max(1, columns)), rows(std::max(1, rowCount)),
+      cellWidth(mapWidth / cols), cellHeight(mapHeight / rows), mode(renderMode),
+      counts(static_cast<size_t>(cols) * rows), glyphs(counts.size()), shown(counts.size()), hasShown(false) {
+    // Полный кадр: заголовок, строки по 2 байта на клетку и легенда.
+    // Кадр разностей не длиннее полного, если на клетку уходит до ~16 байт.
+    size_t fullSize = 128 + static_cast<size_t>(rows) * (cols * 2 + 1) + LEGEND.size();
+    frame.reserve(std::max(fullSize, counts.size() * 16 + 32));
+}
+
+void MapRenderer::countCells(const NpcStore& world) {
+    std::fill(counts.begin(), counts.end(), 0);
+    
+    const double invWidth = 1.0 / cellWidth;
+    const double invHeight = 1.0 / cellHeight;
+    
+    for (size_t i = 0; i < world.size(); i++) {
+        if (!world.alive[i]) continue;
+        
+        // NPC на правой и нижней границе карты попадают в крайнюю клетку
+        int col = std::clamp(static_cast<int>(world.x[i] * invWidth), 0, cols - 1);
+        int row = std::clamp(static_cast<int>(world.y[i] * invHeight), 0, rows - 1);
+        counts[static_cast<size_t>(row) * cols + col]++;
+    }
+    
+    for (size_t c = 0; c < counts.size(); c++) {
+        uint32_t n = counts[c];
+        glyphs[c] = n == 0 ? '.' : n < 10 ? static_cast<char>('0' + n) : '*';
+    }
+}
+
+void MapRenderer::composeFull() {
+    frame.append("\n=== КАРТА ПОДЗЕМЕЛЬЯ ===\nМасштаб: 1 клетка = ");
+    appendNumber(frame, cellWidth);
+    frame.push_back('x');
+    appendNumber(frame, cellHeight);
+    frame.append(" метров\n");
+    
+    for (int row = 0; row < rows; row++) {
+        const char* line = &glyphs[static_cast<size_t>(row) * cols];
+        for (int col = 0; col < cols; col++) {
+            frame.push_back(line[col]);
+            frame.push_back(' ');
+        }
+        frame.push_back('\n');
+    }
+    
+    frame.append(LEGEND);
+}
+
+void MapRenderer::composeDiff() {
+    if (!hasShown) {
+        // Первый кадр: очистка экрана, карта рисуется от левого верхнего угла.
+        // Строки под картой становятся областью прокрутки: журналы и статус
+        // прокручиваются в ней, и строки карты остаются на своих местах.
+        frame.append("\x1b[2J\x1b[H");
+        composeFull();
+        frame.append("\x1b[");
+        appendNumber(frame, frameLines() + 1);
+        frame.append("r\x1b[");
+        appendNumber(frame, frameLines() + 1);
+        frame.append(";1H");
+        shown = glyphs;
+        hasShown = true;
+        return;
+    }
+    
+    // Курсор сохраняется и восстанавливается, чтобы не мешать прочему выводу
+    frame.append("\x1b" "7");
+    size_t before = frame.size();
+    
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            size_t c = static_cast<size_t>(row) * cols + col;
+            if (glyphs[c] == shown[c]) continue;
+            
+            // Строки 1-3 экрана заняты пустой строкой и заголовком
+            frame.append("\x1b[");
+            appendNumber(frame, row + 4);
+            frame.push_back(';');
+            appendNumber(frame, col * 2 + 1);
+            frame.push_back('H');
+            frame.push_back(glyphs[c]);
+            shown[c] = glyphs[c];
+        }
+    }
+    
+    if (frame.size() == before) {
+        frame.clear();
+        return;
+    }
+    frame.append("\x1b" "8");
+}
+
+std::string_view MapRenderer::release() {
+    frame.clear();
+    if (mode == RenderMode::Diff && hasShown) {
+        // Область прокрутки - снова весь экран, курсор - в ее последнюю строку
+        frame.append("\x1b[r\x1b[999;1H\n");
+    }
+    mode = RenderMode::Full;
+    hasShown = false;
+    return frame;
+}
+
+std::string_view MapRenderer::compose(const NpcStore& world) {
+    countCells(world);
+    frame.clear();
+    
+    if (mode == RenderMode::Diff) {
+        composeDiff();
+    } else {
+        composeFull();
+    }
+    return frame;
+}
+
+void MapRenderer::writeFrame(std::string_view data, int fd) {
+    while (!data.empty()) {
+        ssize_t result = ::write(fd, data.data(), data.size());
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data.remove_prefix(static_cast<size_t>(result));
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class NpcStore;
+
+enum class RenderMode {
+    Full,   // каждый кадр рисуется целиком
+    Diff,   // после первого кадра отправляются только изменившиеся клетки (ANSI);
+            // прочий вывод прокручивается в области под картой
+};
+
+// Рисует карту в заранее выделенный буфер и отдает кадр одним write().
+// Разрешение карты задается числом клеток, поэтому размер кадра не зависит
+// ни от размеров мира, ни от числа NPC.
+class MapRenderer {
+private:
+    int cols;
+    int rows;
+    double cellWidth;
+    double cellHeight;
+    RenderMode mode;
+
+    std::vector<uint32_t> counts;
+    std::vector<char> glyphs;
+    std::vector<char> shown;   // что сейчас на экране (для Diff)
+    bool hasShown;
+    std::string frame;
+
+    void countCells(const NpcStore& world);
+    void composeFull();
+    void composeDiff();
+
+public:
+    MapRenderer(double mapWidth, double mapHeight, int columns, int rowCount, RenderMode renderMode = RenderMode::Full);
+
+    // Строит кадр по срезу мира; результат действителен до следующего вызова
+    std::string_view compose(const NpcStore& world);
+
+    // Записывает кадр в дескриптор; обычно это один системный вызов
+    static void writeFrame(std::string_view image, int fd);
+
+    // Следующий кадр в режиме Diff будет нарисован целиком
+    void invalidate() { hasShown = false; }
+    
+    // Снимает закрепление карты (Diff): возвращает последовательность,
+    // которую нужно вывести, дальше кадры рисуются целиком, как в Full
+    std::string_view release();
+    
+    // Строк экрана, которые занимает полный кадр
+    int frameLines() const { return rows + 5; }
+
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+    RenderMode getMode() const { return mode; }
+};
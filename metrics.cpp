@@ -0,0 +1,230 @@
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+std::atomic<uint64_t> nextInstanceId{1};
+volatile std::sig_atomic_t dumpRequested = 0;
+
+void onDumpSignal(int) {
+    dumpRequested = 1;
+}
+
+constexpr const char* GAUGE_NAMES[GAUGE_COUNT] = {
+    "npc_fight_queue_depth", "npc_alive", "npc_ticks_total", "npc_fights_total", "npc_fight_queue_dropped_total",
+    "npc_neighbour_list_rebuilds",
+};
+
+constexpr const char* GAUGE_HELP[GAUGE_COUNT] = {
+    "Задач в очереди боев после поиска",
+    "Живых NPC",
+    "Выполнено тиков",
+    "Разрешено боев",
+    "Задач, отброшенных очередью боев",
+    "Списков соседей, перестроенных на последнем тике",
+};
+
+constexpr const char* GAUGE_TYPES[GAUGE_COUNT] = {"gauge", "gauge", "counter", "counter", "counter", "gauge"};
+
+// Границы корзин для Prometheus в секундах: ряд 1-2.5-5 от 1 мкс до 10 с
+constexpr double PROMETHEUS_BOUNDS[] = {
+    1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+    1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+};
+
+std::string formatMs(uint64_t nanoseconds) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << nanoseconds / 1e6;
+    return out.str();
+}
+
+}
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+
+    size_t shift = static_cast<size_t>(std::bit_width(value)) - 5;
+    if (shift > MAX_SHIFT) return BUCKET_COUNT - 1;
+
+    size_t top = static_cast<size_t>(value >> shift);   // в [16, 31]
+    return SUB_BUCKETS + shift * SUB_BUCKETS + (top - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) return index;
+
+    size_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t top = SUB_BUCKETS + (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    auto bump = [](std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    };
+
+    bump(counts[bucketFor(nanoseconds)], 1);
+    bump(total, 1);
+    bump(sum, nanoseconds);
+    if (nanoseconds > maxValue.load(std::memory_order_relaxed)) {
+        maxValue.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::addTo(HistogramSnapshot& out) const {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        out.counts[i] += counts[i].load(std::memory_order_relaxed);
+    }
+    out.total += total.load(std::memory_order_relaxed);
+    out.sum += sum.load(std::memory_order_relaxed);
+    out.maxValue = std::max(out.maxValue, maxValue.load(std::memory_order_relaxed));
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(LatencyHistogram::bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+Metrics::Metrics() : instanceId(nextInstanceId.fetch_add(1, std::memory_order_relaxed)) {}
+
+Metrics::Shard& Metrics::localShard() {
+    // Кэш потока привязан к id экземпляра, а не к адресу: новый Metrics
+    // по тому же адресу не получит чужой набор гистограмм
+    struct Cache {
+        uint64_t owner = 0;
+        Shard* shard = nullptr;
+    };
+    thread_local Cache cache;
+
+    if (cache.owner != instanceId) {
+        std::lock_guard lock(shardsMutex);
+        shards.push_back(std::make_unique<Shard>());
+        cache.owner = instanceId;
+        cache.shard = shards.back().get();
+    }
+    return *cache.shard;
+}
+
+HistogramSnapshot Metrics::snapshot(Phase phase) {
+    HistogramSnapshot result;
+    std::lock_guard lock(shardsMutex);
+    for (const auto& shard : shards) {
+        shard->phases[static_cast<size_t>(phase)].addTo(result);
+    }
+    return result;
+}
+
+std::string Metrics::formatLine() {
+    std::ostringstream out;
+    out << "[Статистика]";
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        HistogramSnapshot s = snapshot(static_cast<Phase>(p));
+        if (s.total == 0) continue;
+        out << " " << PHASE_NAMES[p] << " p50/p99=" << formatMs(s.percentile(0.5))
+            << "/" << formatMs(s.percentile(0.99)) << "мс";
+    }
+    out << " | очередь=" << getGauge(Gauge::QueueDepth)
+        << " живых=" << getGauge(Gauge::Alive)
+        << " тиков=" << getGauge(Gauge::Ticks)
+        << " боев=" << getGauge(Gauge::Fights);
+    return out.str();
+}
+
+std::string Metrics::formatTable() {
+    std::ostringstream out;
+    out << "=== СТАТИСТИКА ФАЗ (мс) ===\n"
+        << std::left << std::setw(12) << "фаза" << std::right
+        << std::setw(10) << "замеров" << std::setw(10) << "среднее" << std::setw(10) << "p50"
+        << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+        << std::setw(10) << "макс" << "\n";
+
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        HistogramSnapshot s = snapshot(static_cast<Phase>(p));
+        out << std::left << std::setw(12) << PHASE_NAMES[p] << std::right
+            << std::setw(10) << s.total
+            << std::setw(10) << formatMs(static_cast<uint64_t>(s.meanNs()))
+            << std::setw(10) << formatMs(s.percentile(0.5))
+            << std::setw(10) << formatMs(s.percentile(0.9))
+            << std::setw(10) << formatMs(s.percentile(0.99))
+            << std::setw(10) << formatMs(s.percentile(0.999))
+            << std::setw(10) << formatMs(s.maxValue) << "\n";
+    }
+
+    for (size_t g = 0; g < GAUGE_COUNT; g++) {
+        out << GAUGE_NAMES[g] << " = " << getGauge(static_cast<Gauge>(g)) << "\n";
+    }
+    return out.str();
+}
+
+std::string Metrics::formatPrometheus() {
+    std::ostringstream out;
+    out << "# HELP npc_phase_seconds Длительность фаз тика\n"
+        << "# TYPE npc_phase_seconds histogram\n";
+
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        HistogramSnapshot s = snapshot(static_cast<Phase>(p));
+
+        // Корзина HDR целиком попадает в границу le, если ее верхняя граница не больше le
+        size_t bucket = 0;
+        uint64_t cumulative = 0;
+        for (double bound : PROMETHEUS_BOUNDS) {
+            uint64_t limitNs = static_cast<uint64_t>(bound * 1e9);
+            while (bucket < s.counts.size() && LatencyHistogram::bucketUpperBound(bucket) <= limitNs) {
+                cumulative += s.counts[bucket++];
+            }
+            out << "npc_phase_seconds_bucket{phase=\"" << PHASE_NAMES[p] << "\",le=\"" << bound << "\"} "
+                << cumulative << "\n";
+        }
+        out << "npc_phase_seconds_bucket{phase=\"" << PHASE_NAMES[p] << "\",le=\"+Inf\"} " << s.total << "\n"
+            << "npc_phase_seconds_sum{phase=\"" << PHASE_NAMES[p] << "\"} " << s.sum / 1e9 << "\n"
+            << "npc_phase_seconds_count{phase=\"" << PHASE_NAMES[p] << "\"} " << s.total << "\n";
+    }
+
+    for (size_t g = 0; g < GAUGE_COUNT; g++) {
+        out << "# HELP " << GAUGE_NAMES[g] << " " << GAUGE_HELP[g] << "\n"
+            << "# TYPE " << GAUGE_NAMES[g] << " " << GAUGE_TYPES[g] << "\n"
+            << GAUGE_NAMES[g] << " " << getGauge(static_cast<Gauge>(g)) << "\n";
+    }
+    return out.str();
+}
+
+bool Metrics::writePrometheus(const std::string& path) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file.is_open()) return false;
+        file << formatPrometheus();
+        if (!file.good()) return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void Metrics::installDumpSignalHandler() {
+    struct sigaction action{};
+    action.sa_handler = onDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+bool Metrics::consumeDumpRequest() {
+    if (!dumpRequested) return false;
+    dumpRequested = 0;
+    return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class Phase : uint8_t {
+    Tick,       // тик целиком
+    Move,
+    Detect,
+    QueueWait,  // от конца поиска боев до извлечения задач из очереди
+    Resolve,
+    Notify,     // доставка смертей наблюдателям
+    Compact,    // удаление мертвых из хранилища
+    Render,
+};
+
+constexpr size_t PHASE_COUNT = 8;
+constexpr const char* PHASE_NAMES[PHASE_COUNT] = {"tick", "move", "detect", "queue_wait", "resolve", "notify", "compact", "render"};
+
+enum class Gauge : uint8_t {
+    QueueDepth,
+    Alive,
+    Ticks,
+    Fights,
+    QueueDropped,
+    NeighbourRebuilds,   // списков соседей, перестроенных на последнем тике
+};
+
+constexpr size_t GAUGE_COUNT = 6;
+
+// Снимок гистограммы: обычные числа, которые можно складывать и анализировать
+struct HistogramSnapshot;
+
+// Гистограмма задержек в наносекундах с логарифмически-линейными корзинами
+// (как в HdrHistogram): 16 корзин на каждую степень двойки, погрешность ~6%.
+// Пишет только поток-владелец, поэтому запись - это загрузка и сохранение
+// без атомарных RMW; читать снимок можно из любого потока.
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t MAX_SHIFT = 36;   // значения до ~2^41 нс (~36 минут)
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (MAX_SHIFT + 2);
+
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+    void record(uint64_t nanoseconds);
+    void addTo(HistogramSnapshot& out) const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+};
+
+struct HistogramSnapshot {
+    std::array<uint64_t, LatencyHistogram::BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+
+    // Верхняя граница корзины, в которую попал p-й перцентиль (p в [0, 1])
+    uint64_t percentile(double p) const;
+    double meanNs() const { return total ? static_cast<double>(sum) / total : 0.0; }
+};
+
+// Метрики симуляции: гистограммы фаз по потокам и числовые показатели.
+// Каждый поток пишет в свой набор гистограмм; снимок складывает все наборы.
+class Metrics {
+private:
+    struct Shard {
+        std::array<LatencyHistogram, PHASE_COUNT> phases;
+    };
+
+    const uint64_t instanceId;
+    std::mutex shardsMutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::array<std::atomic<int64_t>, GAUGE_COUNT> gauges{};
+
+    Shard& localShard();
+
+public:
+    Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void record(Phase phase, uint64_t nanoseconds) {
+        localShard().phases[static_cast<size_t>(phase)].record(nanoseconds);
+    }
+    void setGauge(Gauge gauge, int64_t value) {
+        gauges[static_cast<size_t>(gauge)].store(value, std::memory_order_relaxed);
+    }
+    int64_t getGauge(Gauge gauge) const {
+        return gauges[static_cast<size_t>(gauge)].load(std::memory_order_relaxed);
+    }
+
+    HistogramSnapshot snapshot(Phase phase);
+
+    // Одна строка с p50/p99 фаз и показателями - для периодического вывода
+    std::string formatLine();
+    // Подробная таблица по всем фазам - для дампа по SIGUSR1
+    std::string formatTable();
+    // Текстовый формат Prometheus; файл заменяется атомарно через rename
+    std::string formatPrometheus();
+    bool writePrometheus(const std::string& path);
+
+    // SIGUSR1 только выставляет флаг; дамп печатает поток симуляции
+    static void installDumpSignalHandler();
+    static bool consumeDumpRequest();
+};
+
+// Замер фазы на время жизни объекта. Без метрик не читает часы вовсе.
+class PhaseTimer {
+private:
+    Metrics* metrics;
+    Phase phase;
+    std::chrono::steady_clock::time_point begin;
+
+public:
+    PhaseTimer(Metrics* target, Phase measured) : metrics(target), phase(measured) {
+        if (metrics) begin = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer() {
+        if (metrics) {
+            auto elapsed = std::chrono::steady_clock::now() - begin;
+            metrics->record(phase, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
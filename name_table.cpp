@@ -0,0 +1,98 @@
+#include "name_table.h"
+#include <charconv>
+#include <cstring>
+#include <mutex>
+
+NameTable& NameTable::global() {
+    static NameTable table;
+    return table;
+}
+
+NameTable::NameTable() : chunkUsed(CHUNK_SIZE) {
+    entries.push_back(std::string_view());
+    lookup.emplace(std::string_view(), 0);
+}
+
+std::string_view NameTable::store(std::string_view text) {
+    if (text.empty()) return std::string_view();
+
+    // Длинная строка получает собственный кусок, текущий при этом не теряется
+    if (text.size() > CHUNK_SIZE / 4) {
+        chunks.push_back(std::make_unique<char[]>(text.size()));
+        char* place = chunks.back().get();
+        std::memcpy(place, text.data(), text.size());
+        return std::string_view(place, text.size());
+    }
+
+    if (chunkUsed + text.size() > CHUNK_SIZE) {
+        chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+        currentChunk = chunks.back().get();
+        chunkUsed = 0;
+    }
+    char* place = currentChunk + chunkUsed;
+    std::memcpy(place, text.data(), text.size());
+    chunkUsed += text.size();
+    return std::string_view(place, text.size());
+}
+
+NameId NameTable::intern(std::string_view text) {
+    {
+        std::shared_lock lock(mutex);
+        auto found = lookup.find(text);
+        if (found != lookup.end()) return NameId{found->second};
+    }
+
+    std::unique_lock lock(mutex);
+    auto found = lookup.find(text);
+    if (found != lookup.end()) return NameId{found->second};
+
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    std::string_view stored = store(text);
+    entries.push_back(stored);
+    lookup.emplace(stored, id);
+    return NameId{id};
+}
+
+std::string_view NameTable::view(NameId id) {
+    if (!id.isGenerated()) {
+        std::shared_lock lock(mutex);
+        return id.value < entries.size() ? entries[id.value] : std::string_view();
+    }
+
+    {
+        std::shared_lock lock(mutex);
+        auto found = shownGenerated.find(id.value);
+        if (found != shownGenerated.end()) return found->second;
+    }
+
+    NameBuffer buffer;
+    std::string_view text = format(id, buffer);
+
+    std::unique_lock lock(mutex);
+    auto [position, inserted] = shownGenerated.emplace(id.value, std::string_view());
+    if (inserted) position->second = store(text);
+    return position->second;
+}
+
+std::string_view NameTable::format(NameId id, NameBuffer& buffer) const {
+    if (!id.isGenerated()) {
+        std::shared_lock lock(mutex);
+        return id.value < entries.size() ? entries[id.value] : std::string_view();
+    }
+
+    const char* prefix = GENERATED_NAME_PREFIX[static_cast<size_t>(id.kind())];
+    size_t length = std::strlen(prefix);
+    std::memcpy(buffer.data, prefix, length);
+    auto [end, error] = std::to_chars(buffer.data + length, buffer.data + sizeof(buffer.data), id.index());
+    return std::string_view(buffer.data, static_cast<size_t>(end - buffer.data));
+}
+
+size_t NameTable::internedCount() const {
+    std::shared_lock lock(mutex);
+    return entries.size() - 1;
+}
+
+size_t NameTable::generatedShown() const {
+    std::shared_lock lock(mutex);
+    return shownGenerated.size();
+}
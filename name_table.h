@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "npc_kind.h"
+
+// Компактный идентификатор имени NPC. Имена бывают двух видов:
+// - интернированные: произвольная строка хранится в таблице один раз;
+// - порождаемые: "Рыцарь_12" задается видом и номером и превращается в
+//   текст, только когда его действительно нужно показать.
+struct NameId {
+    static constexpr uint32_t GENERATED_BIT = 1u << 31;
+    static constexpr uint32_t KIND_SHIFT = 29;
+    static constexpr uint32_t INDEX_MASK = (1u << KIND_SHIFT) - 1;
+
+    uint32_t value = 0;   // 0 - пустое имя
+
+    bool isGenerated() const { return (value & GENERATED_BIT) != 0; }
+    NpcKind kind() const { return static_cast<NpcKind>((value >> KIND_SHIFT) & 3u); }
+    uint32_t index() const { return value & INDEX_MASK; }
+
+    static NameId generated(NpcKind kind, uint32_t index) {
+        return NameId{GENERATED_BIT | (static_cast<uint32_t>(kind) << KIND_SHIFT) | (index & INDEX_MASK)};
+    }
+
+    bool operator==(const NameId& other) const = default;
+};
+
+// Буфер для текста порождаемого имени без выделения памяти
+struct NameBuffer {
+    char data[32];
+};
+
+// Префиксы порождаемых имен по видам
+constexpr const char* GENERATED_NAME_PREFIX[NPC_KIND_COUNT] = {"Рыцарь_", "Орк_", "Медведь_"};
+
+// Таблица имен процесса. Строки лежат в кусках, которые никогда не
+// перемещаются и не освобождаются, поэтому string_view из таблицы
+// действительны до конца работы программы. Потокобезопасна.
+class NameTable {
+public:
+    static NameTable& global();
+
+    NameTable();
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    // Одинаковые строки получают один и тот же идентификатор
+    NameId intern(std::string_view text);
+
+    // Устойчивый текст имени; порождаемое имя при первом показе
+    // записывается в таблицу
+    std::string_view view(NameId id);
+
+    // Текст без записи в таблицу: порождаемое имя форматируется в buffer.
+    // Не выделяет память - для горячих путей вроде журналов боев.
+    std::string_view format(NameId id, NameBuffer& buffer) const;
+
+    size_t internedCount() const;
+    size_t generatedShown() const;
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    mutable std::shared_mutex mutex;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* currentChunk = nullptr;
+    size_t chunkUsed;
+
+    std::vector<std::string_view> entries;
+    std::unordered_map<std::string_view, uint32_t> lookup;
+    std::unordered_map<uint32_t, std::string_view> shownGenerated;
+
+    std::string_view store(std::string_view text);   // под исключительной блокировкой
+};
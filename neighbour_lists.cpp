@@ -0,0 +1,63 @@
+#include "neighbour_lists.h"
+#include <cmath>
+
+NeighbourLists::NeighbourLists(double fightRange, double skinRadius) : range(fightRange), skin(skinRadius), staleCount(0) {}
+
+size_t NeighbourLists::prepare(const NpcStore& frame) {
+    staleCount = 0;
+
+    for (uint32_t slot = 0; slot < frame.size(); slot++) {
+        NpcHandle handle = frame.handles[slot];
+        if (!handle.isValid() || !frame.alive[slot]) continue;
+
+        if (handle.index >= entries.size()) {
+            entries.resize(handle.index + 1);
+            slotOf.resize(handle.index + 1, UINT32_MAX);
+        }
+        slotOf[handle.index] = slot;
+
+        Entry& entry = entries[handle.index];
+        double x = frame.x[slot];
+        double y = frame.y[slot];
+
+        // Индекс реестра мог достаться другому NPC - тогда список чужой
+        if (!entry.built || entry.generation != handle.generation) {
+            entry.stale = true;
+        } else {
+            entry.travelled += std::hypot(x - entry.lastX, y - entry.lastY);
+            entry.stale = entry.travelled > skin / 2;
+        }
+        entry.lastX = x;
+        entry.lastY = y;
+
+        if (entry.stale) staleCount++;
+    }
+    return staleCount;
+}
+
+void NeighbourLists::rebuild(Entry& entry, uint32_t slot, const NpcStore& frame, const SpatialGrid& grid) const {
+    entry.candidates.clear();
+
+    double x = frame.x[slot];
+    double y = frame.y[slot];
+    double radius = range + skin;
+    double radiusSquared = radius * radius;
+    NpcKind kind = frame.type[slot];
+
+    // Вид NPC не меняется, поэтому пары, где никто не может победить, не кэшируются
+    grid.forEachWithin(x, y, radius, [&](int other) {
+        if (other == static_cast<int>(slot) || !frame.alive[other]) return;
+        if (!canFight(kind, frame.type[other])) return;
+
+        double dx = frame.x[other] - x;
+        double dy = frame.y[other] - y;
+        if (dx * dx + dy * dy > radiusSquared) return;
+
+        entry.candidates.push_back(frame.handles[other]);
+    });
+
+    entry.travelled = 0.0;
+    entry.generation = frame.handles[slot].generation;
+    entry.built = true;
+    entry.stale = false;
+}
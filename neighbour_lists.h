@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "npc_handle.h"
+#include "npc_store.h"
+#include "spatial_grid.h"
+
+// Списки соседей Верле. Для каждого NPC хранятся противники в радиусе
+// range + skin на момент построения списка. Пока NPC прошел не больше
+// skin / 2, его список годится: пара, сошедшаяся до range, была ближе
+// range + skin, когда строился более поздний из двух списков, и попала в
+// него. Поэтому дистанция проверяется только по кэшированным кандидатам,
+// а сетка нужна лишь тем, чей список устарел.
+//
+// Списки привязаны к индексам реестра, а не к слотам: уплотнение хранилища
+// переставляет слоты, но не трогает handle.
+class NeighbourLists {
+private:
+    struct Entry {
+        std::vector<NpcHandle> candidates;
+        double lastX = 0.0;
+        double lastY = 0.0;
+        double travelled = 0.0;    // путь с момента построения списка
+        uint32_t generation = 0;
+        bool built = false;
+        bool stale = true;
+    };
+
+    double range;
+    double skin;
+
+    std::vector<Entry> entries;      // по индексу реестра
+    std::vector<uint32_t> slotOf;    // индекс реестра -> слот текущего кадра
+    size_t staleCount;
+
+    void rebuild(Entry& entry, uint32_t slot, const NpcStore& frame, const SpatialGrid& grid) const;
+
+public:
+    NeighbourLists(double fightRange, double skinRadius);
+
+    // Начало тика: учитывает путь каждого NPC с прошлого кадра и отмечает
+    // тех, кому нужен новый список. Возвращает их число - если 0, сетку
+    // на этом тике можно не перестраивать.
+    size_t prepare(const NpcStore& frame);
+
+    // Слоты кадра frame, которые сейчас ближе range к slot. Устаревший
+    // список сначала строится заново по grid. Разные слоты можно
+    // обрабатывать параллельно: каждый пишет только в свой список.
+    template <typename Func>
+    void forEachCandidate(uint32_t slot, const NpcStore& frame, const SpatialGrid& grid, Func&& func) {
+        Entry& entry = entries[frame.handles[slot].index];
+        if (entry.stale) rebuild(entry, slot, frame, grid);
+
+        double x = frame.x[slot];
+        double y = frame.y[slot];
+        double rangeSquared = range * range;
+        for (NpcHandle other : entry.candidates) {
+            if (other.index >= slotOf.size()) continue;
+            uint32_t otherSlot = slotOf[other.index];
+            // Индекс мог освободиться при уплотнении: слот проверяется по handle
+            if (otherSlot >= frame.size() || !(frame.handles[otherSlot] == other)) continue;
+            if (!frame.alive[otherSlot]) continue;
+
+            double dx = frame.x[otherSlot] - x;
+            double dy = frame.y[otherSlot] - y;
+            if (dx * dx + dy * dy > rangeSquared) continue;
+            func(otherSlot);
+        }
+    }
+
+    double getSkin() const { return skin; }
+    size_t lastRebuilds() const { return staleCount; }
+};
@@ -0,0 +1,22 @@
+#include "node_pool.h"
+
+void* NodePool::allocate() {
+    if (!freeList) {
+        chunks.push_back(std::make_unique<Slot[]>(CHUNK_SLOTS));
+        Slot* chunk = chunks.back().get();
+        for (size_t i = 0; i < CHUNK_SLOTS; i++) {
+            chunk[i].next = freeList;
+            freeList = &chunk[i];
+        }
+    }
+
+    Slot* slot = freeList;
+    freeList = slot->next;
+    return slot;
+}
+
+void NodePool::deallocate(void* pointer) noexcept {
+    Slot* slot = static_cast<Slot*>(pointer);
+    slot->next = freeList;
+    freeList = slot;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <vector>
+#include <cstddef>
+
+// Пул ячеек фиксированного размера для узлов контейнеров конвейера боев.
+// Память берется кусками по CHUNK_SLOTS ячеек и после очистки контейнера
+// остается в пуле, поэтому в установившемся режиме узлы не выделяются.
+// Не потокобезопасен: пулом владеет один контейнер одного потока.
+class NodePool {
+public:
+    static constexpr size_t SLOT_SIZE = 32;
+    static constexpr size_t CHUNK_SLOTS = 4096;
+
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate();
+    void deallocate(void* pointer) noexcept;
+
+    size_t chunkCount() const { return chunks.size(); }
+
+private:
+    struct alignas(std::max_align_t) Slot {
+        union {
+            Slot* next;
+            std::byte storage[SLOT_SIZE];
+        };
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot* freeList = nullptr;
+};
+
+// STL-аллокатор: одиночные узлы подходящего размера - из пула, остальное
+// (массивы корзин хеш-таблицы) - из обычной кучи
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(NodePool& target) noexcept : pool(&target) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(size_t count) {
+        if (fitsSlot(count)) return static_cast<T*>(pool->allocate());
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        if (fitsSlot(count)) {
+            pool->deallocate(pointer);
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept { return pool == other.pool; }
+
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    NodePool* pool;
+
+    static constexpr bool fitsSlot(size_t count) {
+        return count == 1 && sizeof(T) <= NodePool::SLOT_SIZE && alignof(T) <= alignof(std::max_align_t);
+    }
+};
@@ -1,65 +1,125 @@
 #include "npc.h"
+#include "npc_store.h"
 #include <cmath>
 #include <algorithm>
+#include <random>
 
-std::random_device NPC::rd;
-std::mt19937 NPC::gen(NPC::rd());
-std::uniform_int_distribution<> NPC::dice(1, 6);
+std::atomic<uint32_t> NPC::nextId(0);
+const CounterRng NPC::defaultRng(std::random_device{}());
 
-NPC::NPC(const std::string& n, double xPos, double yPos, double moveDist) : name(n), x(xPos), y(yPos), alive(true), moveDistance(moveDist) {}
+NPC::NPC(NameId n, double xPos, double yPos, double moveDist, NpcKind k) : nameId(n), x(xPos), y(yPos), alive(true), moveDistance(moveDist), kind(k), store(nullptr), slot(0),
+    id(nextId.fetch_add(1, std::memory_order_relaxed)), rngCounter(0) {}
 
-std::string NPC::getName() const {
-    return name;
+NPC::NPC(std::string_view n, double xPos, double yPos, double moveDist, NpcKind k)
+    : NPC(NameTable::global().intern(n), xPos, yPos, moveDist, k) {}
+
+std::string_view NPC::getName() const {
+    return NameTable::global().view(getNameId());
+}
+
+NameId NPC::getNameId() const {
+    return store ? store->names[slot] : nameId;
 }
 
 double NPC::getX() const {
-    return x;
+    return store ? store->x[slot] : x;
 }
 
 double NPC::getY() const {
-    return y;
+    return store ? store->y[slot] : y;
 }
 
 bool NPC::isAlive() const {
-    return alive;
+    return store ? store->alive[slot] != 0 : alive;
 }
 
 double NPC::getMoveDistance() const {
     return moveDistance;
 }
 
+NpcKind NPC::getKind() const {
+    return kind;
+}
+
+NpcHandle NPC::getHandle() const {
+    return store ? store->handles[slot] : handle;
+}
+
+void NPC::setHandle(NpcHandle h) {
+    handle = h;
+    if (store) store->handles[slot] = h;
+}
+
+void NPC::attach(NpcStore* s, uint32_t storeSlot) {
+    store = s;
+    slot = storeSlot;
+}
+
+void NPC::detach() {
+    if (!store) return;
+    x = store->x[slot];
+    y = store->y[slot];
+    alive = store->alive[slot] != 0;
+    handle = store->handles[slot];
+    nameId = store->names[slot];
+    store = nullptr;
+    slot = 0;
+}
+
+bool NPC::isAttached() const {
+    return store != nullptr;
+}
+
+uint32_t NPC::getSlot() const {
+    return slot;
+}
+
+uint32_t NPC::getRngId() const {
+    NpcHandle h = getHandle();
+    return h.isValid() ? h.index : id;
+}
+
 void NPC::move(double maxX, double maxY) {
-    if (!alive) return;
+    if (!isAlive()) return;
     
-    std::uniform_real_distribution<> dirDist(0.0, 2.0 * M_PI);
-    std::uniform_real_distribution<> distDist(0.0, moveDistance);
+    uint32_t tick = rngCounter++;
+    double direction = defaultRng.uniform(id, tick, RngPurpose::MoveDirection) * 2.0 * M_PI;
+    double distance = defaultRng.uniform(id, tick, RngPurpose::MoveDistance) * moveDistance;
     
-    double direction = dirDist(gen);
-    double distance = distDist(gen);
+    double& posX = store ? store->x[slot] : x;
+    double& posY = store ? store->y[slot] : y;
     
-    double newX = x + distance * cos(direction);
-    double newY = y + distance * sin(direction);
+    double newX = posX + distance * cos(direction);
+    double newY = posY + distance * sin(direction);
     
     newX = std::max(0.0, std::min(newX, maxX - 1));
     newY = std::max(0.0, std::min(newY, maxY - 1));
     
-    x = newX;
-    y = newY;
+    posX = newX;
+    posY = newY;
+}
+
+bool NPC::canDefeat(const NPC& other) const {
+    return canBeat(kind, other.kind);
 }
 
 double NPC::distanceTo(const NPC& other) const {
-    return sqrt(pow(x - other.x, 2) + pow(y - other.y, 2));
+    return sqrt(pow(getX() - other.getX(), 2) + pow(getY() - other.getY(), 2));
 }
 
-bool NPC::isInKillingRange(const NPC& other) const {
-    return distanceTo(other) <= 10.0;
+bool NPC::isInKillingRange(const NPC& other, double range) const {
+    return distanceTo(other) <= range;
 }
 
 void NPC::fight(NPC& other) {
-    if (!alive || !other.alive) return;
+    fight(other, defaultRng, rngCounter++);
+}
+
+void NPC::fight(NPC& other, const CounterRng& rng, uint32_t tick) {
+    if (!isAlive() || !other.isAlive()) return;
     
-    int attackPower = rollDice();
-    int defensePower = other.rollDice();
+    int attackPower = rollDice(rng, tick, RngPurpose::AttackDice, other.getRngId());
+    int defensePower = other.rollDice(rng, tick, RngPurpose::DefenseDice, getRngId());
     
     if (canDefeat(other) && attackPower > defensePower) {
         other.die();
@@ -68,8 +128,9 @@ void NPC::fight(NPC& other) {
 
 void NPC::die() {
     alive = false;
+    if (store) store->alive[slot] = 0;
 }
 
-int NPC::rollDice() {
-    return dice(gen);
+int NPC::rollDice(const CounterRng& rng, uint32_t tick, RngPurpose purpose, uint32_t opponent) const {
+    return rng.dice(getRngId(), tick, purpose, opponent);
 }
\ No newline at end of file
@@ -1,42 +1,78 @@
 #pragma once
 #include <string>
-#include <random>
+#include <string_view>
+#include <cstdint>
+#include <atomic>
+#include "npc_handle.h"
+#include "counter_rng.h"
+#include "npc_kind.h"
+#include "name_table.h"
 
 class BattleVisitor;
+class NpcStore;
 
 class NPC {
 protected:
-    std::string name;
+    NameId nameId;
     double x, y;
     bool alive;
     double moveDistance; 
+    NpcKind kind;
+    NpcHandle handle;
     
-    static std::random_device rd;
-    static std::mt19937 gen;
-    static std::uniform_int_distribution<> dice;
+    // Если NPC привязан к хранилищу, его состояние читается и пишется
+    // через NpcStore, а собственные поля больше не используются
+    NpcStore* store;
+    uint32_t slot;
+    
+    // Потоки случайных чисел NPC вне мира: собственный id и счетчик шагов
+    uint32_t id;
+    uint32_t rngCounter;
+    
+    static std::atomic<uint32_t> nextId;
+    static const CounterRng defaultRng;
     
 public:
-    NPC(const std::string& n, double xPos, double yPos, double moveDist);
+    NPC(NameId n, double xPos, double yPos, double moveDist, NpcKind k);
+    // Имя интернируется в NameTable::global()
+    NPC(std::string_view n, double xPos, double yPos, double moveDist, NpcKind k);
     virtual ~NPC() = default;
 
-    virtual std::string getType() const = 0;
-    std::string getName() const;
+    virtual std::string_view getType() const = 0;
+    // Имя без копирования; строка живет в таблице имен до конца программы.
+    // Порождаемое имя при первом вызове записывается в таблицу.
+    std::string_view getName() const;
+    NameId getNameId() const;
     double getX() const;
     double getY() const;
     bool isAlive() const;
     double getMoveDistance() const;
+    NpcKind getKind() const;
+    NpcHandle getHandle() const;
+    void setHandle(NpcHandle h);
+    
+    void attach(NpcStore* s, uint32_t storeSlot);
+    // Забирает состояние слота в собственные поля и отвязывается от хранилища
+    void detach();
+    bool isAttached() const;
+    uint32_t getSlot() const;
+    
+    uint32_t getRngId() const;
     
     void move(double maxX, double maxY);
     
     double distanceTo(const NPC& other) const;
-    bool isInKillingRange(const NPC& other) const;
+    // Дистанция боя по умолчанию; мир задает свою через SimulationConfig::fightRange
+    static constexpr double DEFAULT_FIGHT_RANGE = 10.0;
+    bool isInKillingRange(const NPC& other, double range = DEFAULT_FIGHT_RANGE) const;
     
-    virtual bool canDefeat(const NPC& other) const = 0;
+    bool canDefeat(const NPC& other) const;
     virtual void fight(NPC& other);
+    void fight(NPC& other, const CounterRng& rng, uint32_t tick);
     
     void die();
     
     virtual void accept(BattleVisitor& visitor) = 0;
     
-    static int rollDice();
+    int rollDice(const CounterRng& rng, uint32_t tick, RngPurpose purpose, uint32_t opponent) const;
 };
\ No newline at end of file
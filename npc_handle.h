@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+struct NpcHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != INVALID_INDEX; }
+    bool operator==(const NpcHandle& other) const = default;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+enum class NpcKind : uint8_t {
+    Knight,
+    Orc,
+    Bear,
+};
+
+constexpr std::size_t NPC_KIND_COUNT = 3;
+
+// Имена видов совпадают с NPC::getType()
+constexpr const char* NPC_KIND_NAMES[NPC_KIND_COUNT] = {"Knight", "Orc", "Bear"};
+
+constexpr const char* kindName(NpcKind kind) {
+    return NPC_KIND_NAMES[static_cast<std::size_t>(kind)];
+}
+
+// MATCHUP[a][b] - может ли NPC вида a победить NPC вида b
+constexpr bool MATCHUP[NPC_KIND_COUNT][NPC_KIND_COUNT] = {
+    //            Knight  Orc    Bear
+    /* Knight */ {false, true,  false},
+    /* Orc    */ {false, false, true },
+    /* Bear   */ {true,  false, false},
+};
+
+constexpr bool canBeat(NpcKind attacker, NpcKind defender) {
+    return MATCHUP[static_cast<std::size_t>(attacker)][static_cast<std::size_t>(defender)];
+}
+
+// Пара, в которой никто не может победить, не требует боя
+constexpr bool canFight(NpcKind a, NpcKind b) {
+    return canBeat(a, b) || canBeat(b, a);
+}
+
+static_assert(canBeat(NpcKind::Knight, NpcKind::Orc));
+static_assert(canBeat(NpcKind::Orc, NpcKind::Bear));
+static_assert(canBeat(NpcKind::Bear, NpcKind::Knight));
+static_assert(!canFight(NpcKind::Knight, NpcKind::Knight));
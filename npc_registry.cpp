@@ -0,0 +1,29 @@
+#include "npc_registry.h"
+#include "npc.h"
+
+NpcHandle NpcRegistry::add(NPC* npc) {
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    
+    slots[index].npc = npc;
+    NpcHandle handle{index, slots[index].generation};
+    npc->setHandle(handle);
+    return handle;
+}
+
+void NpcRegistry::remove(NpcHandle handle) {
+    NPC* npc = get(handle);
+    if (!npc) return;
+    
+    Slot& slot = slots[handle.index];
+    slot.npc = nullptr;
+    slot.generation++;
+    freeIndices.push_back(handle.index);
+    npc->setHandle(NpcHandle{});
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "npc_handle.h"
+
+class NPC;
+
+class NpcRegistry {
+private:
+    struct Slot {
+        NPC* npc = nullptr;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeIndices;
+
+public:
+    NpcHandle add(NPC* npc);
+    // Запас и под освобожденные индексы: удаление не выделяет память
+    void reserve(std::size_t count) { slots.reserve(count); freeIndices.reserve(count); }
+    void remove(NpcHandle handle);
+
+    NPC* get(NpcHandle handle) const {
+        if (handle.index >= slots.size()) return nullptr;
+        const Slot& slot = slots[handle.index];
+        return slot.generation == handle.generation ? slot.npc : nullptr;
+    }
+
+    std::size_t capacity() const { return slots.size(); }
+};
@@ -0,0 +1,108 @@
+#include "npc_store.h"
+#include "npc.h"
+
+uint32_t NpcStore::add(NPC& npc) {
+    uint32_t slot = static_cast<uint32_t>(size());
+    
+    x.push_back(npc.getX());
+    y.push_back(npc.getY());
+    alive.push_back(npc.isAlive() ? 1 : 0);
+    type.push_back(npc.getKind());
+    moveDistance.push_back(npc.getMoveDistance());
+    handles.push_back(npc.getHandle());
+    names.push_back(npc.getNameId());
+    views.push_back(&npc);
+    
+    npc.attach(this, slot);
+    return slot;
+}
+
+void NpcStore::reserve(std::size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    alive.reserve(count);
+    type.reserve(count);
+    moveDistance.reserve(count);
+    handles.reserve(count);
+    names.reserve(count);
+    views.reserve(count);
+}
+
+void NpcStore::copyStateFrom(const NpcStore& other) {
+    x.assign(other.x.begin(), other.x.end());
+    y.assign(other.y.begin(), other.y.end());
+    alive.assign(other.alive.begin(), other.alive.end());
+    type.assign(other.type.begin(), other.type.end());
+    moveDistance.assign(other.moveDistance.begin(), other.moveDistance.end());
+    handles.assign(other.handles.begin(), other.handles.end());
+    views.assign(other.views.begin(), other.views.end());
+    names.assign(other.names.begin(), other.names.end());
+}
+
+void NpcStore::moveSlot(uint32_t from, uint32_t to) {
+    x[to] = x[from];
+    y[to] = y[from];
+    alive[to] = alive[from];
+    type[to] = type[from];
+    moveDistance[to] = moveDistance[from];
+    handles[to] = handles[from];
+    names[to] = names[from];
+    views[to] = views[from];
+    views[to]->attach(this, to);
+}
+
+std::size_t NpcStore::removeDead(std::vector<std::shared_ptr<NPC>>& owners,
+                                 std::vector<std::shared_ptr<NPC>>& removed) {
+    std::size_t end = size();
+    std::size_t before = end;
+    
+    for (std::size_t slot = 0; slot < end;) {
+        if (alive[slot]) {
+            slot++;
+            continue;
+        }
+        
+        views[slot]->detach();
+        removed.push_back(std::move(owners[slot]));
+        
+        // Переехавший слот проверяется на следующем шаге: он мог умереть тоже
+        end--;
+        if (slot != end) {
+            moveSlot(static_cast<uint32_t>(end), static_cast<uint32_t>(slot));
+            owners[slot] = std::move(owners[end]);
+        }
+    }
+    
+    x.resize(end);
+    y.resize(end);
+    alive.resize(end);
+    type.resize(end);
+    moveDistance.resize(end);
+    handles.resize(end);
+    names.resize(end);
+    views.resize(end);
+    owners.resize(end);
+    return before - end;
+}
+
+void NpcStore::releaseSpare() {
+    constexpr std::size_t MIN_CAPACITY = 1024;
+    if (x.capacity() <= MIN_CAPACITY || size() * 4 >= x.capacity()) return;
+    
+    x.shrink_to_fit();
+    y.shrink_to_fit();
+    alive.shrink_to_fit();
+    type.shrink_to_fit();
+    moveDistance.shrink_to_fit();
+    handles.shrink_to_fit();
+    names.shrink_to_fit();
+    views.shrink_to_fit();
+}
+
+std::size_t NpcStore::aliveCount() const {
+    std::size_t count = 0;
+    for (uint8_t a : alive) {
+        count += a;
+    }
+    return count;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "npc_handle.h"
+#include "npc_kind.h"
+#include "name_table.h"
+
+class NPC;
+
+// Хранилище NPC в виде структуры массивов: горячие данные (координаты,
+// состояние, тип) лежат подряд, объекты NPC хранятся отдельно. Вместо имен -
+// четырехбайтовые NameId, текст живет в NameTable.
+class NpcStore {
+public:
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<uint8_t> alive;
+    std::vector<NpcKind> type;
+    std::vector<double> moveDistance;
+    std::vector<NpcHandle> handles;
+
+    std::vector<NameId> names;
+    std::vector<NPC*> views;
+
+    uint32_t add(NPC& npc);
+    void reserve(std::size_t count);
+    
+    // Копирует состояние слотов другого хранилища в существующие буферы
+    void copyStateFrom(const NpcStore& other);
+    
+    // Переносит слот from на место to и перепривязывает его NPC
+    void moveSlot(uint32_t from, uint32_t to);
+    
+    // Удаляет мертвые слоты: на место мертвого переезжает последний слот,
+    // поэтому живые остаются плотно в начале массивов. Мертвые NPC
+    // отвязываются - их состояние переходит в собственные поля объекта.
+    // owners - владеющие указатели, параллельные слотам; указатели мертвых
+    // перекладываются в removed. Возвращает число удаленных слотов.
+    std::size_t removeDead(std::vector<std::shared_ptr<NPC>>& owners,
+                           std::vector<std::shared_ptr<NPC>>& removed);
+    
+    // Отдает память массивов, если занято меньше четверти емкости
+    void releaseSpare();
+
+    std::size_t size() const { return x.size(); }
+    std::size_t aliveCount() const;
+};
@@ -1,62 +1,102 @@
 #include "observer.h"
-#include <iostream>
+#include "npc.h"
 #include <chrono>
-#include <iomanip>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std::chrono;
 
 std::mutex DeathObserver::logMutex;
-std::mutex ConsoleObserver::coutMutex;
 
 std::unique_lock<std::mutex> DeathObserver::getLock() {
     return std::unique_lock<std::mutex>(logMutex);
 }
 
-void ConsoleObserver::onDeath(const std::string& killer, const std::string& victim) {
-    std::lock_guard lock(coutMutex);
-    
-    auto now = system_clock::now();
-    auto now_time = system_clock::to_time_t(now);
-    
-    std::cout << "[БОЙ] " << std::put_time(std::localtime(&now_time), "%H:%M:%S") 
-              << " - " << killer << " убил " << victim << std::endl;
+static std::string describe(const NPC& npc) {
+    NameBuffer buffer;
+    std::string text(NameTable::global().format(npc.getNameId(), buffer));
+    text.append(" (").append(npc.getType()).append(")");
+    return text;
 }
 
-FileObserver::FileObserver(const std::string& fname) : filename(fname) {
-    std::lock_guard lock(logMutex);
-    logFile.open(filename, std::ios::app);
+void DeathObserver::onDeathEvent(const DeathEvent& event) {
+    onDeath(describe(event.killer), describe(event.victim));
+}
+
+// Та же строка, что дает onDeathEvent по умолчанию, но частями прямо в запись
+// журнала. Имена форматируются на стеке, чтобы не заносить в таблицу имена
+// всех погибших.
+static void logDeath(AsyncLogger& logger, const DeathEvent& event) {
+    const NameTable& names = NameTable::global();
+    NameBuffer killer, victim;
+    logger.log({names.format(event.killer.getNameId(), killer), " (", kindName(event.killer.getKind()), ") убил ",
+                names.format(event.victim.getNameId(), victim), " (", kindName(event.victim.getKind()), ")"});
+}
+
+AsyncLogger& ConsoleObserver::logger() {
+    static AsyncLogger instance(STDOUT_FILENO, "[БОЙ] ", false);
+    return instance;
+}
+
+void ConsoleObserver::onDeath(std::string_view killer, std::string_view victim) {
+    logger().log({killer, " убил ", victim});
+}
+
+void ConsoleObserver::onDeathEvent(const DeathEvent& event) {
+    logDeath(logger(), event);
+}
+
+void ConsoleObserver::flush() {
+    logger().flush();
+}
+
+FileObserver::FileObserver(const std::string& fname) : filename(fname), fd(-1) {
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
     
-    if (logFile.is_open()) {
-        auto now = system_clock::now();
-        auto now_time = system_clock::to_time_t(now);
-        
-        logFile << "\n=== НАЧАЛО СЕССИИ ЛОГИРОВАНИЯ ===" << std::endl;
-        logFile << "Время: " << std::put_time(std::localtime(&now_time), "%Y-%m-%d %H:%M:%S") 
-                << std::endl;
+    if (fd >= 0) {
+        writeSessionMark("\n=== НАЧАЛО СЕССИИ ЛОГИРОВАНИЯ ===");
+        logger = std::make_unique<AsyncLogger>(fd, "", false);
     }
 }
 
 FileObserver::~FileObserver() {
-    std::lock_guard lock(logMutex);
-    if (logFile.is_open()) {
-        auto now = system_clock::now();
-        auto now_time = system_clock::to_time_t(now);
-        
-        logFile << "=== КОНЕЦ СЕССИИ ЛОГИРОВАНИЯ ===" << std::endl;
-        logFile << "Время: " << std::put_time(std::localtime(&now_time), "%Y-%m-%d %H:%M:%S") 
-                << std::endl;
-        logFile.close();
+    if (fd >= 0) {
+        // Очередь дописывается не дольше DEFAULT_SHUTDOWN_TIMEOUT
+        logger->shutdown();
+        writeSessionMark("=== КОНЕЦ СЕССИИ ЛОГИРОВАНИЯ ===");
+        ::close(fd);
     }
 }
 
-void FileObserver::onDeath(const std::string& killer, const std::string& victim) {
-    std::lock_guard lock(logMutex);
+// Отметки сессии пишутся синхронно, пока фоновый поток журнала не работает
+void FileObserver::writeSessionMark(const char* title) {
+    auto now_time = system_clock::to_time_t(system_clock::now());
+    std::tm local{};
+    localtime_r(&now_time, &local);
+    
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
     
-    if (logFile.is_open()) {
-        auto now = system_clock::now();
-        auto now_time = system_clock::to_time_t(now);
-        
-        logFile << std::put_time(std::localtime(&now_time), "%H:%M:%S") 
-                << " - " << killer << " убил " << victim << std::endl;
+    std::string text = std::string(title) + "\nВремя: " + date + "\n";
+    std::lock_guard lock(logMutex);
+    [[maybe_unused]] ssize_t written = ::write(fd, text.data(), text.size());
+}
+
+void FileObserver::onDeath(std::string_view killer, std::string_view victim) {
+    if (logger) {
+        logger->log({killer, " убил ", victim});
     }
-}
\ No newline at end of file
+}
+
+void FileObserver::onDeathEvent(const DeathEvent& event) {
+    if (logger) {
+        logDeath(*logger, event);
+    }
+}
+
+void FileObserver::flush() {
+    if (logger) {
+        logger->flush();
+    }
+}
@@ -1,39 +1,65 @@
 #pragma once
 
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <memory>
 #include <mutex>
+#include <cstdint>
+#include "async_logger.h"
+
+class NPC;
+
+// Смерть NPC в бою. Жертва на момент уведомления уже мертва.
+struct DeathEvent {
+    uint32_t tick;
+    const NPC& killer;
+    const NPC& victim;
+};
 
 class DeathObserver {
 protected:
     static std::mutex logMutex;
     
 public:
-    virtual void onDeath(const std::string& killer, const std::string& victim) = 0;
+    virtual void onDeath(std::string_view killer, std::string_view victim) = 0;
     virtual ~DeathObserver() = default;
     
+    // По умолчанию событие превращается в текст "Имя (Тип)" и уходит в onDeath.
+    // Журналы переопределяют его, чтобы писать без промежуточных строк.
+    virtual void onDeathEvent(const DeathEvent& event);
+    
+    // Дожидается записи всех уже полученных событий
+    virtual void flush() {}
+    
     static std::unique_lock<std::mutex> getLock();
 };
 
+// Все ConsoleObserver пишут в stdout через один общий фоновый журнал
 class ConsoleObserver : public DeathObserver {
 private:
-    static std::mutex coutMutex;
+    static AsyncLogger& logger();
     
 public:
-    void onDeath(const std::string& killer, const std::string& victim) override;
+    void onDeath(std::string_view killer, std::string_view victim) override;
+    void onDeathEvent(const DeathEvent& event) override;
+    void flush() override;
 };
 
 class FileObserver : public DeathObserver {
 private:
-    std::ofstream logFile;
     std::string filename;
+    int fd;
+    std::unique_ptr<AsyncLogger> logger;
+    
+    void writeSessionMark(const char* title);
     
 public:
     FileObserver(const std::string& filename);
     ~FileObserver();
     
-    void onDeath(const std::string& killer, const std::string& victim) override;
+    void onDeath(std::string_view killer, std::string_view victim) override;
+    void onDeathEvent(const DeathEvent& event) override;
+    void flush() override;
     
-    bool isFileOpen() const { return logFile.is_open(); }
-};
\ No newline at end of file
+    bool isFileOpen() const { return fd >= 0; }
+};
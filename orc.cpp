@@ -2,14 +2,12 @@
 #include "knight.h"
 #include "bear.h"
 
-Orc::Orc(const std::string& n, double xPos, double yPos) : NPC(n, xPos, yPos, 20.0) {}
+Orc::Orc(NameId n, double xPos, double yPos) : NPC(n, xPos, yPos, 20.0, NpcKind::Orc) {}
 
-std::string Orc::getType() const {
-    return "Orc";
-}
+Orc::Orc(std::string_view n, double xPos, double yPos) : NPC(n, xPos, yPos, 20.0, NpcKind::Orc) {}
 
-bool Orc::canDefeat(const NPC& other) const {
-    return other.getType() == "Bear";
+std::string_view Orc::getType() const {
+    return "Orc";
 }
 
 void Orc::accept(BattleVisitor& visitor) {
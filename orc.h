@@ -4,10 +4,10 @@
 
 class Orc : public NPC {
 public:
-    Orc(const std::string& n, double xPos, double yPos);
+    Orc(NameId n, double xPos, double yPos);
+    Orc(std::string_view n, double xPos, double yPos);
     
-    std::string getType() const override;
-    bool canDefeat(const NPC& other) const override;
+    std::string_view getType() const override;
     
     void accept(BattleVisitor& visitor) override;
 };
\ No newline at end of file
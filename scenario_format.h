@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// Бинарный снимок сценария: заголовок и столбцы, которые копируются в
+// NpcStore без разбора. Порядок байт - родной для машины, на которой
+// снимок записан. Все разделы выровнены по 8 байт.
+//
+//   ScenarioHeader
+//   double   x[npcCount]
+//   double   y[npcCount]
+//   uint8_t  kinds[npcCount]          (NpcKind)
+//   uint32_t nameOffsets[npcCount + 1]
+//   char     names[namesBytes]        (имена подряд, без разделителей)
+struct ScenarioHeader {
+    static constexpr char MAGIC[8] = {'N', 'P', 'C', 'S', 'C', 'E', 'N', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t npcCount;
+    uint64_t namesBytes;
+    double mapWidth;
+    double mapHeight;
+    uint32_t tick;          // тик, на котором снят мир (0 - исходный сценарий)
+    uint32_t reserved;
+
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(magic)) == 0 && version == VERSION &&
+               headerSize == sizeof(ScenarioHeader);
+    }
+};
+
+static_assert(sizeof(ScenarioHeader) == 56);
+
+// Смещения разделов от начала файла
+struct ScenarioLayout {
+    uint64_t x;
+    uint64_t y;
+    uint64_t kinds;
+    uint64_t nameOffsets;
+    uint64_t names;
+    uint64_t totalBytes;
+
+    static constexpr uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t{7}; }
+
+    static constexpr ScenarioLayout of(uint64_t count, uint64_t namesBytes) {
+        ScenarioLayout layout{};
+        layout.x = align(sizeof(ScenarioHeader));
+        layout.y = layout.x + count * sizeof(double);
+        layout.kinds = layout.y + count * sizeof(double);
+        layout.nameOffsets = align(layout.kinds + count);
+        layout.names = align(layout.nameOffsets + (count + 1) * sizeof(uint32_t));
+        layout.totalBytes = layout.names + namesBytes;
+        return layout;
+    }
+};
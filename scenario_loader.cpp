@@ -0,0 +1,411 @@
+#include "scenario_loader.h"
+#include "scenario_format.h"
+#include "factory.h"
+#include "npc_store.h"
+#include "npc_registry.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Куски меньше этого не делятся: накладные расходы пула больше выигрыша
+constexpr size_t MIN_CHUNK_BYTES = 64 * 1024;
+constexpr size_t POPULATE_CHUNK = 4096;
+
+// Файл, отображенный в память только для чтения
+class MappedFile {
+private:
+    int fd = -1;
+    void* base = MAP_FAILED;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Не удалось открыть " + path);
+
+        struct stat info{};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Не удалось прочитать размер " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) return;
+
+        base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Не удалось отобразить в память " + path);
+        }
+        ::madvise(base, length, MADV_WILLNEED);
+    }
+
+    ~MappedFile() {
+        if (base != MAP_FAILED) ::munmap(base, length);
+        if (fd >= 0) ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base == MAP_FAILED ? nullptr : static_cast<const char*>(base); }
+    size_t size() const { return length; }
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string_view nextToken(const char*& cursor, const char* end) {
+    while (cursor < end && isBlank(*cursor)) cursor++;
+    const char* begin = cursor;
+    while (cursor < end && !isBlank(*cursor)) cursor++;
+    return std::string_view(begin, static_cast<size_t>(cursor - begin));
+}
+
+bool parseKind(std::string_view token, NpcKind& kind) {
+    for (size_t i = 0; i < NPC_KIND_COUNT; i++) {
+        if (token == NPC_KIND_NAMES[i]) {
+            kind = static_cast<NpcKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseDouble(std::string_view token, double& value) {
+    auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return error == std::errc() && end == token.data() + token.size();
+}
+
+bool inBounds(double x, double y, double maxX, double maxY) {
+    return x > 0 && x <= maxX && y > 0 && y <= maxY;
+}
+
+enum class LineStatus { Parsed, Skipped, Invalid };
+
+// Разбирает строку прямо в ячейку index столбцов результата
+LineStatus parseLine(std::string_view line, size_t index, double maxX, double maxY, ScenarioData& out,
+                     std::string& error) {
+    const char* cursor = line.data();
+    const char* end = line.data() + line.size();
+
+    std::string_view typeToken = nextToken(cursor, end);
+    if (typeToken.empty() || typeToken.front() == '#') return LineStatus::Skipped;
+
+    std::string_view nameToken = nextToken(cursor, end);
+    std::string_view xToken = nextToken(cursor, end);
+    std::string_view yToken = nextToken(cursor, end);
+
+    NpcKind kind;
+    double x, y;
+    if (nameToken.empty() || yToken.empty()) {
+        error = "ожидается \"Тип Имя X Y\"";
+    } else if (!parseKind(typeToken, kind)) {
+        error = "неизвестный тип " + std::string(typeToken);
+    } else if (!parseDouble(xToken, x) || !parseDouble(yToken, y)) {
+        error = "некорректные координаты";
+    } else if (!inBounds(x, y, maxX, maxY)) {
+        error = "координаты вне карты";
+    } else {
+        out.kinds[index] = kind;
+        out.x[index] = x;
+        out.y[index] = y;
+        out.names[index].assign(nameToken);
+        return LineStatus::Parsed;
+    }
+    return LineStatus::Invalid;
+}
+
+// Оставляет только отмеченные строки, сохраняя порядок
+void compact(ScenarioData& data, const std::vector<uint8_t>& keep) {
+    size_t kept = 0;
+    for (size_t i = 0; i < keep.size(); i++) {
+        if (!keep[i]) continue;
+        if (kept != i) {
+            data.kinds[kept] = data.kinds[i];
+            data.x[kept] = data.x[i];
+            data.y[kept] = data.y[i];
+            data.names[kept] = std::move(data.names[i]);
+        }
+        kept++;
+    }
+    data.kinds.resize(kept);
+    data.x.resize(kept);
+    data.y.resize(kept);
+    data.names.resize(kept);
+}
+
+void resizeColumns(ScenarioData& data, size_t count) {
+    data.kinds.resize(count);
+    data.x.resize(count);
+    data.y.resize(count);
+    data.names.resize(count);
+}
+
+}
+
+ScenarioData ScenarioLoader::parseText(std::string_view text, double maxX, double maxY, ThreadPool& pool) {
+    ScenarioData result;
+    if (text.empty()) return result;
+
+    // Границы кусков сдвигаются на начало строки, каждая строка достается ровно одному куску
+    size_t chunkCount = std::clamp<size_t>(text.size() / MIN_CHUNK_BYTES, 1, pool.size() * 4);
+    std::vector<size_t> bounds(chunkCount + 1);
+    for (size_t i = 0; i < chunkCount; i++) {
+        size_t pos = text.size() * i / chunkCount;
+        if (pos > 0) {
+            size_t newline = text.find('\n', pos - 1);
+            pos = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        bounds[i] = std::max(pos, i > 0 ? bounds[i - 1] : 0);
+    }
+    bounds[chunkCount] = text.size();
+
+    // Первый проход: число строк в кусках, чтобы знать, куда писать каждую
+    std::vector<size_t> firstLine(chunkCount + 1, 0);
+    pool.parallelFor(chunkCount, [&](size_t chunk) {
+        std::string_view part = text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]);
+        size_t lines = static_cast<size_t>(std::count(part.begin(), part.end(), '\n'));
+        if (!part.empty() && part.back() != '\n') lines++;
+        firstLine[chunk + 1] = lines;
+    });
+    for (size_t i = 0; i < chunkCount; i++) {
+        firstLine[i + 1] += firstLine[i];
+    }
+
+    size_t lineCount = firstLine[chunkCount];
+    resizeColumns(result, lineCount);
+    std::vector<uint8_t> parsed(lineCount, 0);
+    std::vector<std::vector<std::string>> chunkErrors(chunkCount);
+    std::vector<size_t> chunkRejected(chunkCount, 0);
+
+    // Второй проход: разбор прямо в столбцы, каждый кусок пишет свои строки
+    pool.parallelFor(chunkCount, [&](size_t chunk) {
+        std::string_view part = text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]);
+        size_t index = firstLine[chunk];
+        std::string error;
+
+        while (!part.empty()) {
+            size_t newline = part.find('\n');
+            std::string_view line = part.substr(0, newline);
+            part.remove_prefix(newline == std::string_view::npos ? part.size() : newline + 1);
+
+            LineStatus status = parseLine(line, index, maxX, maxY, result, error);
+            if (status == LineStatus::Parsed) {
+                parsed[index] = 1;
+            } else if (status == LineStatus::Invalid) {
+                chunkRejected[chunk]++;
+                if (chunkErrors[chunk].size() < MAX_REPORTED_ERRORS) {
+                    chunkErrors[chunk].push_back("строка " + std::to_string(index + 1) + ": " + error);
+                }
+            }
+            index++;
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        result.rejected += chunkRejected[chunk];
+        for (auto& message : chunkErrors[chunk]) {
+            if (result.errors.size() < MAX_REPORTED_ERRORS) result.errors.push_back(std::move(message));
+        }
+    }
+
+    if (std::find(parsed.begin(), parsed.end(), 0) != parsed.end()) {
+        compact(result, parsed);
+    }
+    return result;
+}
+
+ScenarioData ScenarioLoader::loadText(const std::string& path, double maxX, double maxY, ThreadPool& pool) {
+    MappedFile file(path);
+    return parseText(std::string_view(file.data(), file.size()), maxX, maxY, pool);
+}
+
+ScenarioData ScenarioLoader::loadSnapshot(const std::string& path, double maxX, double maxY) {
+    MappedFile file(path);
+
+    ScenarioHeader header{};
+    if (file.size() < sizeof(header)) throw std::runtime_error("Снимок " + path + " обрезан");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (!header.isValid()) throw std::runtime_error("Неверная сигнатура или версия снимка " + path);
+
+    // Поля заголовка не доверенные: большие значения переполнили бы расчет
+    // раскладки и прошли бы проверку длины, поэтому сначала они сверяются
+    // с размером файла - тогда суммы в ScenarioLayout::of не переполняются
+    if (header.npcCount > file.size() / sizeof(double) || header.namesBytes > file.size()) {
+        throw std::runtime_error("Снимок " + path + " обрезан");
+    }
+    ScenarioLayout layout = ScenarioLayout::of(header.npcCount, header.namesBytes);
+    if (layout.totalBytes > file.size()) throw std::runtime_error("Снимок " + path + " обрезан");
+
+    size_t count = static_cast<size_t>(header.npcCount);
+    const char* base = file.data();
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(base + layout.nameOffsets);
+    const uint8_t* kinds = reinterpret_cast<const uint8_t*>(base + layout.kinds);
+    const char* names = base + layout.names;
+
+    // Столбцы копируются целиком; разбираются только имена
+    ScenarioData result;
+    result.x.assign(reinterpret_cast<const double*>(base + layout.x),
+                    reinterpret_cast<const double*>(base + layout.x) + count);
+    result.y.assign(reinterpret_cast<const double*>(base + layout.y),
+                    reinterpret_cast<const double*>(base + layout.y) + count);
+    result.kinds.resize(count);
+    result.names.resize(count);
+
+    std::vector<uint8_t> valid(count, 1);
+    for (size_t i = 0; i < count; i++) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.namesBytes) {
+            throw std::runtime_error("Поврежден раздел имен снимка " + path);
+        }
+        result.names[i].assign(names + offsets[i], offsets[i + 1] - offsets[i]);
+        result.kinds[i] = static_cast<NpcKind>(kinds[i]);
+
+        if (kinds[i] >= NPC_KIND_COUNT || !inBounds(result.x[i], result.y[i], maxX, maxY)) {
+            valid[i] = 0;
+            result.rejected++;
+            if (result.errors.size() < MAX_REPORTED_ERRORS) {
+                result.errors.push_back("запись " + std::to_string(i) + ": неизвестный тип или координаты вне карты");
+            }
+        }
+    }
+
+    if (result.rejected > 0) compact(result, valid);
+    return result;
+}
+
+ScenarioData ScenarioLoader::load(const std::string& path, double maxX, double maxY, ThreadPool& pool) {
+    char magic[sizeof(ScenarioHeader::MAGIC)] = {};
+    {
+        std::ifstream probe(path, std::ios::binary);
+        if (!probe.is_open()) throw std::runtime_error("Не удалось открыть " + path);
+        probe.read(magic, sizeof(magic));
+    }
+
+    if (std::memcmp(magic, ScenarioHeader::MAGIC, sizeof(magic)) == 0) {
+        return loadSnapshot(path, maxX, maxY);
+    }
+    return loadText(path, maxX, maxY, pool);
+}
+
+bool ScenarioLoader::saveSnapshot(const std::string& path, const NpcStore& store,
+                                  double mapWidth, double mapHeight, uint32_t tick) {
+    // Порождаемые имена форматируются во временный буфер и в таблицу не попадают
+    const NameTable& nameTable = NameTable::global();
+    NameBuffer buffer;
+
+    std::vector<size_t> living;
+    uint64_t namesBytes = 0;
+    for (size_t i = 0; i < store.size(); i++) {
+        if (!store.alive[i]) continue;
+        living.push_back(i);
+        namesBytes += nameTable.format(store.names[i], buffer).size();
+    }
+    if (namesBytes > UINT32_MAX) return false;
+
+    ScenarioLayout layout = ScenarioLayout::of(living.size(), namesBytes);
+    std::vector<char> image(layout.totalBytes, 0);
+
+    ScenarioHeader header{};
+    std::memcpy(header.magic, ScenarioHeader::MAGIC, sizeof(header.magic));
+    header.version = ScenarioHeader::VERSION;
+    header.headerSize = sizeof(ScenarioHeader);
+    header.npcCount = living.size();
+    header.namesBytes = namesBytes;
+    header.mapWidth = mapWidth;
+    header.mapHeight = mapHeight;
+    header.tick = tick;
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    double* xs = reinterpret_cast<double*>(image.data() + layout.x);
+    double* ys = reinterpret_cast<double*>(image.data() + layout.y);
+    uint8_t* kinds = reinterpret_cast<uint8_t*>(image.data() + layout.kinds);
+    uint32_t* offsets = reinterpret_cast<uint32_t*>(image.data() + layout.nameOffsets);
+    char* names = image.data() + layout.names;
+
+    uint32_t offset = 0;
+    for (size_t k = 0; k < living.size(); k++) {
+        size_t i = living[k];
+        xs[k] = store.x[i];
+        ys[k] = store.y[i];
+        kinds[k] = static_cast<uint8_t>(store.type[i]);
+        offsets[k] = offset;
+        std::string_view name = nameTable.format(store.names[i], buffer);
+        std::memcpy(names + offset, name.data(), name.size());
+        offset += static_cast<uint32_t>(name.size());
+    }
+    offsets[living.size()] = offset;
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!file.good()) return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void ScenarioLoader::populate(ScenarioData&& data, NpcStore& store, NpcRegistry& registry,
+                              std::vector<std::shared_ptr<NPC>>& npcs, ThreadPool& pool, SlabArena* arena) {
+    size_t base = store.size();
+    size_t count = data.size();
+    size_t firstNpc = npcs.size();
+
+    // Пустое хранилище забирает столбцы целиком, без копирования
+    if (base == 0) {
+        store.x = std::move(data.x);
+        store.y = std::move(data.y);
+        store.type = std::move(data.kinds);
+    } else {
+        store.x.insert(store.x.end(), data.x.begin(), data.x.end());
+        store.y.insert(store.y.end(), data.y.begin(), data.y.end());
+        store.type.insert(store.type.end(), data.kinds.begin(), data.kinds.end());
+    }
+
+    // Интернирование идет под блокировкой таблицы, поэтому делается одним потоком
+    NameTable& nameTable = NameTable::global();
+    store.names.reserve(base + count);
+    for (const std::string& name : data.names) {
+        store.names.push_back(nameTable.intern(name));
+    }
+    store.alive.resize(base + count, 1);
+    store.moveDistance.resize(base + count);
+    store.handles.resize(base + count);
+    store.views.resize(base + count);
+    npcs.resize(firstNpc + count);
+
+    // Имя и координаты NPC живут в хранилище, поэтому объект создается без имени
+    const NameId unnamed;
+    if (arena) arena->reserve(count * NPCFactory::ARENA_BYTES_PER_NPC);
+    size_t chunks = (count + POPULATE_CHUNK - 1) / POPULATE_CHUNK;
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * POPULATE_CHUNK);
+        for (size_t i = chunk * POPULATE_CHUNK; i < end; i++) {
+            size_t slot = base + i;
+            std::shared_ptr<NPC> npc = arena
+                ? NPCFactory::createShared(store.type[slot], unnamed, store.x[slot], store.y[slot], *arena)
+                : std::shared_ptr<NPC>(NPCFactory::createNPC(store.type[slot], unnamed, store.x[slot], store.y[slot]));
+            npc->attach(&store, static_cast<uint32_t>(slot));
+            store.moveDistance[slot] = npc->getMoveDistance();
+            store.views[slot] = npc.get();
+            npcs[firstNpc + i] = std::move(npc);
+        }
+    });
+
+    // Индексы реестра - идентификаторы NPC в мире, поэтому регистрация идет по порядку
+    registry.reserve(registry.capacity() + count);
+    for (size_t i = 0; i < count; i++) {
+        registry.add(store.views[base + i]);
+    }
+}
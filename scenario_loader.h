@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "npc_kind.h"
+
+class NPC;
+class NpcStore;
+class NpcRegistry;
+class ThreadPool;
+class SlabArena;
+
+// Разобранный сценарий: столбцы в порядке строк файла
+struct ScenarioData {
+    std::vector<NpcKind> kinds;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<std::string> names;
+
+    size_t rejected = 0;              // строки с ошибками
+    std::vector<std::string> errors;  // описания первых ошибок
+
+    size_t size() const { return kinds.size(); }
+};
+
+// Массовая загрузка NPC. Текстовый формат - строки "Тип Имя X Y", как у
+// NPCFactory::loadFromString; пустые строки и строки с '#' пропускаются.
+// Текст отображается в память и разбирается кусками в пуле потоков прямо
+// в столбцы результата. Бинарный снимок (scenario_format.h) копируется
+// столбцами без разбора.
+class ScenarioLoader {
+public:
+    static constexpr size_t MAX_REPORTED_ERRORS = 10;
+
+    static ScenarioData parseText(std::string_view text, double maxX, double maxY, ThreadPool& pool);
+
+    // Ошибки открытия файла и неверный формат снимка - std::runtime_error
+    static ScenarioData loadText(const std::string& path, double maxX, double maxY, ThreadPool& pool);
+    static ScenarioData loadSnapshot(const std::string& path, double maxX, double maxY);
+    // Формат определяется по сигнатуре файла
+    static ScenarioData load(const std::string& path, double maxX, double maxY, ThreadPool& pool);
+
+    // Сохраняет живых NPC хранилища; false при ошибке записи
+    static bool saveSnapshot(const std::string& path, const NpcStore& store,
+                             double mapWidth, double mapHeight, uint32_t tick = 0);
+
+    // Создает объекты NPC, дописывает столбцы в хранилище и регистрирует
+    // NPC в реестре в порядке сценария. Столбцы data забираются. С ареной
+    // объекты размещаются в ней, без арены - в куче.
+    static void populate(ScenarioData&& data, NpcStore& store, NpcRegistry& registry,
+                         std::vector<std::shared_ptr<NPC>>& npcs, ThreadPool& pool, SlabArena* arena = nullptr);
+};
@@ -0,0 +1,231 @@
+#include "simulation_config.h"
+#include <fstream>
+#include <stdexcept>
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+template <typename T>
+T parseNumber(const std::string& key, const std::string& value) {
+    T result{};
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || end != value.data() + value.size()) {
+        throw std::invalid_argument("Некорректное значение '" + value + "' для " + key);
+    }
+    return result;
+}
+
+bool parseBool(const std::string& key, const std::string& value) {
+    if (value.empty() || value == "1" || value == "true" || value == "yes") return true;
+    if (value == "0" || value == "false" || value == "no") return false;
+    throw std::invalid_argument("Некорректное значение '" + value + "' для " + key);
+}
+
+}
+
+void SimulationConfig::set(const std::string& key, const std::string& value) {
+    if (key == "npcs") {
+        npcCount = parseNumber<int>(key, value);
+    } else if (key == "width") {
+        mapWidth = parseNumber<double>(key, value);
+    } else if (key == "height") {
+        mapHeight = parseNumber<double>(key, value);
+    } else if (key == "fight-range") {
+        fightRange = parseNumber<double>(key, value);
+    } else if (key == "neighbour-skin") {
+        neighbourSkin = parseNumber<double>(key, value);
+    } else if (key == "tick-rate") {
+        tickRate = parseNumber<double>(key, value);
+    } else if (key == "duration") {
+        durationSeconds = parseNumber<double>(key, value);
+    } else if (key == "ticks") {
+        maxTicks = parseNumber<uint64_t>(key, value);
+    } else if (key == "seed") {
+        seed = parseNumber<uint64_t>(key, value);
+    } else if (key == "threads") {
+        threads = parseNumber<unsigned>(key, value);
+    } else if (key == "queue-capacity") {
+        fightQueueCapacity = parseNumber<size_t>(key, value);
+    } else if (key == "unthrottled") {
+        unthrottled = parseBool(key, value);
+    } else if (key == "overrun") {
+        if (value == "catch-up") {
+            overrunPolicy = OverrunPolicy::CatchUp;
+        } else if (value == "skip") {
+            overrunPolicy = OverrunPolicy::Skip;
+        } else {
+            throw std::invalid_argument("Политика опоздания должна быть catch-up или skip");
+        }
+    } else if (key == "render-every") {
+        renderEvery = parseNumber<int>(key, value);
+    } else if (key == "metrics") {
+        metrics = parseBool(key, value);
+    } else if (key == "stats-interval") {
+        statsIntervalSeconds = parseNumber<double>(key, value);
+    } else if (key == "metrics-file") {
+        metricsFile = value;
+    } else if (key == "hugepages") {
+        hugePages = parseBool(key, value);
+    } else if (key == "scenario") {
+        scenarioFile = value;
+    } else if (key == "save-scenario") {
+        saveScenarioFile = value;
+    } else if (key == "trace") {
+        traceFile = value;
+    } else if (key == "headless") {
+        headless = parseBool(key, value);
+    } else if (key == "render-cols") {
+        renderCols = parseNumber<int>(key, value);
+    } else if (key == "render-rows") {
+        renderRows = parseNumber<int>(key, value);
+    } else if (key == "render-mode") {
+        if (value == "full") {
+            renderMode = RenderMode::Full;
+        } else if (value == "diff") {
+            renderMode = RenderMode::Diff;
+        } else {
+            throw std::invalid_argument("Режим отрисовки должен быть full или diff");
+        }
+    } else {
+        throw std::invalid_argument("Неизвестный параметр: " + key);
+    }
+}
+
+void SimulationConfig::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::invalid_argument("Не удалось открыть файл конфигурации: " + path);
+    }
+    
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::string_view text = trim(line);
+        if (text.empty() || text.front() == '#') continue;
+        
+        size_t eq = text.find('=');
+        if (eq == std::string_view::npos) {
+            throw std::invalid_argument(path + ":" + std::to_string(lineNumber) + ": ожидается ключ = значение");
+        }
+        set(std::string(trim(text.substr(0, eq))), std::string(trim(text.substr(eq + 1))));
+    }
+}
+
+void SimulationConfig::validate() const {
+    // from_chars принимает "nan" и "inf": сравнения ниже их не отсекают,
+    // а дальше они ломают расчет размеров сетки и числа тиков
+    const std::pair<const char*, double> reals[] = {
+        {"width", mapWidth}, {"height", mapHeight}, {"fight-range", fightRange},
+        {"neighbour-skin", neighbourSkin}, {"tick-rate", tickRate}, {"duration", durationSeconds},
+        {"stats-interval", statsIntervalSeconds},
+    };
+    for (const auto& [key, value] : reals) {
+        if (!std::isfinite(value)) throw std::invalid_argument(std::string("Значение ") + key + " должно быть конечным числом");
+    }
+    if (npcCount < 0) throw std::invalid_argument("Количество NPC не может быть отрицательным");
+    if (mapWidth <= 0 || mapHeight <= 0) throw std::invalid_argument("Размеры карты должны быть положительными");
+    if (fightRange <= 0) throw std::invalid_argument("Дистанция боя должна быть положительной");
+    if (neighbourSkin < 0) throw std::invalid_argument("Запас списков соседей не может быть отрицательным");
+    if (tickRate <= 0) throw std::invalid_argument("Частота тиков должна быть положительной");
+    if (renderEvery < 0) throw std::invalid_argument("Интервал отрисовки не может быть отрицательным");
+    if (statsIntervalSeconds <= 0) throw std::invalid_argument("Интервал статистики должен быть положительным");
+    if (metrics && metricsFile.empty()) throw std::invalid_argument("Не задан файл метрик");
+    if (durationSeconds < 0) throw std::invalid_argument("Длительность не может быть отрицательной");
+    if (fightQueueCapacity == 0) throw std::invalid_argument("Емкость очереди боев должна быть положительной");
+    if (renderCols <= 0 || renderRows <= 0) throw std::invalid_argument("Разрешение карты должно быть положительным");
+    if (headless && durationSeconds == 0 && maxTicks == 0) {
+        throw std::invalid_argument("В режиме headless нужна длительность или число тиков");
+    }
+}
+
+uint64_t SimulationConfig::tickLimit() const {
+    uint64_t byDuration = static_cast<uint64_t>(std::llround(durationSeconds * tickRate));
+    if (durationSeconds > 0 && byDuration == 0) byDuration = 1;
+    if (byDuration == 0) return maxTicks;
+    if (maxTicks == 0) return byDuration;
+    return std::min(byDuration, maxTicks);
+}
+
+int SimulationConfig::renderInterval() const {
+    if (renderEvery > 0) return renderEvery;
+    return std::max(1, static_cast<int>(std::lround(tickRate)));
+}
+
+SimulationConfig SimulationConfig::fromArgs(int argc, const char* const* argv) {
+    SimulationConfig config;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.showHelp = true;
+            continue;
+        }
+        if (!arg.starts_with("--")) {
+            throw std::invalid_argument("Неожиданный аргумент: " + std::string(arg));
+        }
+        
+        std::string key(arg.substr(2));
+        std::string value;
+        
+        // Поддерживаются формы --ключ=значение, --ключ значение и флаги --headless, --unthrottled, --metrics, --hugepages
+        size_t eq = key.find('=');
+        if (eq != std::string::npos) {
+            value = key.substr(eq + 1);
+            key.resize(eq);
+        } else if (key != "headless" && key != "unthrottled" && key != "metrics" && key != "hugepages") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Нет значения для --" + key);
+            }
+            value = argv[++i];
+        }
+        
+        if (key == "config") {
+            config.loadFile(value);
+        } else {
+            config.set(key, value);
+        }
+    }
+    
+    config.validate();
+    return config;
+}
+
+std::string SimulationConfig::usage() {
+    return "Параметры:\n"
+           "  --config ФАЙЛ          файл с параметрами (ключ = значение)\n"
+           "  --npcs N               начальное количество NPC (50)\n"
+           "  --width W, --height H  размеры карты в метрах (100x100)\n"
+           "  --fight-range R        дистанция боя (10)\n"
+           "  --neighbour-skin S     списки соседей с запасом S м, 0 - выключены (0)\n"
+           "  --tick-rate N          тиков на секунду симулированного времени (10)\n"
+           "  --duration S           симулированное время в секундах, 0 - без ограничения (30)\n"
+           "  --ticks N              остановиться после N тиков\n"
+           "  --unthrottled          тики без пауз, с максимальной скоростью\n"
+           "  --overrun catch-up|skip  что делать с опоздавшими тиками (catch-up)\n"
+           "  --render-every N       отрисовка раз в N тиков, 0 - раз в секунду симуляции\n"
+           "  --seed N               зерно мира\n"
+           "  --threads N            потоков в пуле, 0 - по числу ядер\n"
+           "  --queue-capacity N     емкость очереди боев (4096)\n"
+           "  --headless             без отрисовки и пауз, в конце - отчет о скорости\n"
+           "  --metrics              гистограммы фаз; дамп по SIGUSR1\n"
+           "  --stats-interval S     период строки статистики и файла метрик (5)\n"
+           "  --metrics-file ФАЙЛ    файл в формате Prometheus (metrics.prom)\n"
+           "  --hugepages            арена NPC в страницах по 2 МБ\n"
+           "  --scenario ФАЙЛ        загрузить NPC из текста или бинарного снимка вместо --npcs\n"
+           "  --save-scenario ФАЙЛ   сохранить начальный мир бинарным снимком\n"
+           "  --trace ФАЙЛ           трасса потоков для Perfetto (JSON), пишется при остановке\n"
+           "  --render-cols N, --render-rows N  разрешение карты в клетках (10x10)\n"
+           "  --render-mode full|diff\n";
+}
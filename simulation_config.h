@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include "map_renderer.h"
+#include "tick_scheduler.h"
+
+// Параметры симуляции. Задаются флагами командной строки или файлом
+// вида "ключ = значение" (строки с # - комментарии); ключи файла
+// совпадают с именами флагов без "--". Ошибки сообщаются исключениями
+// std::invalid_argument.
+struct SimulationConfig {
+    int npcCount = 50;
+    double mapWidth = 100.0;
+    double mapHeight = 100.0;
+    double fightRange = 10.0;
+    // Запас списков соседей Верле; 0 - поиск по сетке с нуля каждый тик
+    double neighbourSkin = 0.0;
+    double tickRate = 10.0;          // шаг симуляции: тиков на секунду симулированного времени
+    double durationSeconds = 30.0;   // симулированное время, 0 - без ограничения
+    uint64_t maxTicks = 0;           // 0 - без ограничения по тикам
+    bool unthrottled = false;        // тики без пауз, не дожидаясь своего слота
+    OverrunPolicy overrunPolicy = OverrunPolicy::CatchUp;
+    int renderEvery = 0;             // отрисовка раз в N тиков, 0 - раз в симулированную секунду
+    std::optional<uint64_t> seed;    // без значения берется из random_device
+    unsigned threads = 0;            // 0 - по числу ядер
+    size_t fightQueueCapacity = 4096;
+
+    // Без отрисовки и консольного лога, без пауз: мир крутится с максимальной скоростью
+    bool headless = false;
+
+    int renderCols = 10;
+    int renderRows = 10;
+    RenderMode renderMode = RenderMode::Full;
+
+    // Гистограммы фаз и показатели; без флага замеры не делаются вовсе
+    bool metrics = false;
+    double statsIntervalSeconds = 5.0;   // строка статистики и файл Prometheus, по wall-clock
+    std::string metricsFile = "metrics.prom";
+    
+    // Блоки арены NPC из страниц по 2 МБ (если система их дает)
+    bool hugePages = false;
+    
+    // Сценарий: текст "Тип Имя X Y" или бинарный снимок; заменяет случайную генерацию
+    std::string scenarioFile;
+    // Куда сохранить начальный мир бинарным снимком для быстрого старта
+    std::string saveScenarioFile;
+    
+    // Трасса потоков в формате Chrome Trace Event; пустой путь - без трассировки
+    std::string traceFile;
+
+    bool showHelp = false;
+
+    // Число тиков прогона с учетом duration и ticks, 0 - без ограничения
+    uint64_t tickLimit() const;
+    int renderInterval() const;
+    bool isThrottled() const { return !headless && !unthrottled; }
+
+    void set(const std::string& key, const std::string& value);
+    void loadFile(const std::string& path);
+    void validate() const;
+
+    static SimulationConfig fromArgs(int argc, const char* const* argv);
+    static std::string usage();
+};
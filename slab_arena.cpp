@@ -0,0 +1,113 @@
+#include "slab_arena.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SlabArena::SlabArena(size_t size, bool huge) : blockSize(std::max<size_t>(size, 4096)), hugePages(huge) {}
+
+SlabArena::~SlabArena() {
+    for (auto& block : blocks) {
+        ::munmap(block->base, block->size);
+    }
+}
+
+SlabArena::Block* SlabArena::mapBlock(size_t bytes) {
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t granularity = hugePages ? HUGE_PAGE_SIZE : page;
+    size_t size = (bytes + granularity - 1) / granularity * granularity;
+
+    void* mapped = MAP_FAILED;
+    if (hugePages) {
+        mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapped != MAP_FAILED) hugeMapped.store(true, std::memory_order_relaxed);
+    }
+    if (mapped == MAP_FAILED) {
+        mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) throw std::bad_alloc();
+        // Без зарезервированных страниц по 2 МБ просим прозрачные
+        if (hugePages) ::madvise(mapped, size, MADV_HUGEPAGE);
+    }
+
+    auto block = std::make_unique<Block>();
+    block->base = static_cast<char*>(mapped);
+    block->size = size;
+    blocks.push_back(std::move(block));
+    return blocks.back().get();
+}
+
+void* SlabArena::allocate(size_t bytes, size_t alignment) {
+    if (alignment > ALIGNMENT) throw std::invalid_argument("SlabArena: выравнивание больше 16 байт");
+    size_t size = roundUp(std::max<size_t>(bytes, 1));
+    size_t sizeClass = size / ALIGNMENT - 1;
+
+    if (sizeClass < SIZE_CLASSES && freeCells.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard lock(mutex);
+        if (FreeCell* cell = freeLists[sizeClass]) {
+            freeLists[sizeClass] = cell->next;
+            freeCells.fetch_sub(1, std::memory_order_relaxed);
+            return cell;
+        }
+    }
+
+    // Крупный объект получает собственное отображение и не тратит текущий блок
+    if (size > blockSize / 4) {
+        std::lock_guard lock(mutex);
+        Block* block = mapBlock(size);
+        block->used.store(size, std::memory_order_relaxed);
+        return block->base;
+    }
+
+    while (true) {
+        Block* block = current.load(std::memory_order_acquire);
+        if (block) {
+            size_t offset = block->used.fetch_add(size, std::memory_order_relaxed);
+            if (offset + size <= block->size) return block->base + offset;
+        }
+
+        // Блок кончился: новый заводит один поток, остальные повторяют попытку
+        std::lock_guard lock(mutex);
+        if (current.load(std::memory_order_relaxed) == block) {
+            current.store(mapBlock(blockSize), std::memory_order_release);
+        }
+    }
+}
+
+void SlabArena::deallocate(void* pointer, size_t bytes) {
+    if (!pointer) return;
+    size_t sizeClass = roundUp(std::max<size_t>(bytes, 1)) / ALIGNMENT - 1;
+
+    // Крупные куски остаются за ареной до ее разрушения
+    if (sizeClass >= SIZE_CLASSES) return;
+
+    std::lock_guard lock(mutex);
+    FreeCell* cell = static_cast<FreeCell*>(pointer);
+    cell->next = freeLists[sizeClass];
+    freeLists[sizeClass] = cell;
+    freeCells.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SlabArena::reserve(size_t bytes) {
+    std::lock_guard lock(mutex);
+    Block* block = current.load(std::memory_order_relaxed);
+    if (block) {
+        size_t used = std::min(block->used.load(std::memory_order_relaxed), block->size);
+        if (block->size - used >= bytes) return;
+    }
+    current.store(mapBlock(std::max(bytes, blockSize)), std::memory_order_release);
+}
+
+size_t SlabArena::blockCount() const {
+    std::lock_guard lock(mutex);
+    return blocks.size();
+}
+
+size_t SlabArena::bytesMapped() const {
+    std::lock_guard lock(mutex);
+    size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block->size;
+    }
+    return total;
+}
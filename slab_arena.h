@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Арена для долгоживущих объектов (NPC): память берется у системы крупными
+// блоками через mmap и раздается сдвигом указателя, без блокировки в общем
+// случае. Освобожденные объекты малых размеров уходят в списки свободных
+// ячеек своего класса и переиспользуются; блоки возвращаются системе только
+// при разрушении арены, поэтому арена должна пережить все свои объекты.
+// С hugePages блоки запрашиваются из страниц по 2 МБ (MAP_HUGETLB), а если
+// их нет - обычные блоки помечаются MADV_HUGEPAGE.
+class SlabArena {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = HUGE_PAGE_SIZE;
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t SIZE_CLASSES = 32;   // малые объекты до 512 байт
+
+    explicit SlabArena(size_t blockSize = DEFAULT_BLOCK_SIZE, bool hugePages = false);
+    ~SlabArena();
+
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = ALIGNMENT);
+    void deallocate(void* pointer, size_t bytes);
+
+    // Готовит непрерывный блок хотя бы на bytes байт, чтобы массовое
+    // создание объектов обошлось одним отображением
+    void reserve(size_t bytes);
+
+    size_t blockCount() const;
+    size_t bytesMapped() const;
+    bool usesHugePages() const { return hugeMapped.load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        char* base;
+        size_t size;
+        std::atomic<size_t> used{0};
+    };
+
+    struct FreeCell {
+        FreeCell* next;
+    };
+
+    const size_t blockSize;
+    const bool hugePages;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::atomic<Block*> current{nullptr};
+    std::atomic<bool> hugeMapped{false};
+
+    std::array<FreeCell*, SIZE_CLASSES> freeLists{};
+    std::atomic<size_t> freeCells{0};
+
+    static size_t roundUp(size_t bytes) { return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    Block* mapBlock(size_t bytes);   // под mutex
+};
+
+// STL-аллокатор поверх арены; нужен для std::allocate_shared, чтобы объект
+// и его блок управления лежали одним куском в арене
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(SlabArena& target) noexcept : arena(&target) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        static_assert(alignof(T) <= SlabArena::ALIGNMENT);
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        arena->deallocate(pointer, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    SlabArena* arena;
+};
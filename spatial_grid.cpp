@@ -0,0 +1,44 @@
+#include "spatial_grid.h"
+#include "npc_store.h"
+#include <cmath>
+
+SpatialGrid::SpatialGrid(double width, double height, double size) : cellSize(size),
+    cols(std::max(1, static_cast<int>(std::ceil(width / size)))),
+    rows(std::max(1, static_cast<int>(std::ceil(height / size)))),
+    cellStart(cols * rows + 1, 0) {}
+
+int SpatialGrid::cellCol(double x) const {
+    return std::clamp(static_cast<int>(x / cellSize), 0, cols - 1);
+}
+
+int SpatialGrid::cellRow(double y) const {
+    return std::clamp(static_cast<int>(y / cellSize), 0, rows - 1);
+}
+
+void SpatialGrid::rebuild(const NpcStore& store) {
+    const size_t cellCount = cellStart.size() - 1;
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    entryCell.resize(store.size());
+
+    for (size_t i = 0; i < store.size(); i++) {
+        if (!store.alive[i]) {
+            entryCell[i] = -1;
+            continue;
+        }
+        int cell = cellRow(store.y[i]) * cols + cellCol(store.x[i]);
+        entryCell[i] = cell;
+        cellStart[cell]++;
+    }
+
+    for (size_t cell = 1; cell < cellCount; cell++) {
+        cellStart[cell] += cellStart[cell - 1];
+    }
+    cellStart[cellCount] = cellCount > 0 ? cellStart[cellCount - 1] : 0;
+
+    entries.resize(cellStart[cellCount]);
+    for (size_t i = store.size(); i-- > 0;) {
+        int cell = entryCell[i];
+        if (cell < 0) continue;
+        entries[--cellStart[cell]] = static_cast<int>(i);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+class NpcStore;
+
+class SpatialGrid {
+private:
+    double cellSize;
+    int cols;
+    int rows;
+
+    std::vector<int> cellStart;
+    std::vector<int> entries;
+    std::vector<int> entryCell;
+
+public:
+    SpatialGrid(double width, double height, double cellSize);
+
+    void rebuild(const NpcStore& store);
+
+    int cellCol(double x) const;
+    int cellRow(double y) const;
+    double getCellSize() const { return cellSize; }
+
+    // Обходит слоты NpcStore из клетки (col, row) и восьми соседних с ней
+    template <typename Func>
+    void forEachNeighbour(int col, int row, Func&& func) const {
+        for (int r = std::max(0, row - 1); r <= std::min(rows - 1, row + 1); r++) {
+            for (int c = std::max(0, col - 1); c <= std::min(cols - 1, col + 1); c++) {
+                int cell = r * cols + c;
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    func(entries[i]);
+                }
+            }
+        }
+    }
+
+    // Обходит слоты из клеток, пересекающих квадрат со стороной 2 * radius
+    // вокруг (x, y); радиус может быть больше размера клетки
+    template <typename Func>
+    void forEachWithin(double x, double y, double radius, Func&& func) const {
+        int colFrom = cellCol(x - radius), colTo = cellCol(x + radius);
+        int rowFrom = cellRow(y - radius), rowTo = cellRow(y + radius);
+        for (int r = rowFrom; r <= rowTo; r++) {
+            for (int c = colFrom; c <= colTo; c++) {
+                int cell = r * cols + c;
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    func(entries[i]);
+                }
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEachInCell(int col, int row, Func&& func) const {
+        int cell = row * cols + col;
+        for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+            func(entries[i]);
+        }
+    }
+};
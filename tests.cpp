@@ -4,12 +4,43 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+#include <set>
+#include <filesystem>
 #include "npc.h"
 #include "knight.h"
 #include "orc.h"
 #include "bear.h"
 #include "factory.h"
 #include "game_manager.h"
+#include "spatial_grid.h"
+#include "visitor.h"
+#include "npc_registry.h"
+#include "npc_store.h"
+#include "batch_mover.h"
+#include "counter_rng.h"
+#include "fight_queue.h"
+#include "thread_pool.h"
+#include "fight_resolver.h"
+#include "world_snapshot.h"
+#include "async_logger.h"
+#include "binary_log_observer.h"
+#include "map_renderer.h"
+#include "tick_scheduler.h"
+#include "metrics.h"
+#include "tracer.h"
+#include "scenario_loader.h"
+#include "scenario_format.h"
+#include "slab_arena.h"
+#include "node_pool.h"
+#include "neighbour_lists.h"
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 using namespace std::chrono_literals;
 
@@ -90,6 +121,1050 @@ TEST(NPCTest, CombatRules) {
     EXPECT_FALSE(bear.canDefeat(bear));
 }
 
+TEST(NPCTest, KindMatchupTable) {
+    Knight knight("Рыцарь", 0, 0);
+    Orc orc("Орк", 0, 0);
+    Bear bear("Медведь", 0, 0);
+    
+    EXPECT_EQ(knight.getKind(), NpcKind::Knight);
+    EXPECT_EQ(orc.getKind(), NpcKind::Orc);
+    EXPECT_EQ(bear.getKind(), NpcKind::Bear);
+    
+    EXPECT_TRUE(canFight(NpcKind::Knight, NpcKind::Orc));
+    EXPECT_TRUE(canFight(NpcKind::Orc, NpcKind::Knight));
+    EXPECT_FALSE(canFight(NpcKind::Orc, NpcKind::Orc));
+    EXPECT_FALSE(canFight(NpcKind::Bear, NpcKind::Bear));
+}
+
+// ==================== ТЕСТЫ ДЛЯ NPC STORE ====================
+
+TEST(NpcStoreTest, NpcIsViewOntoStore) {
+    Knight knight("Артур", 10, 20);
+    Orc orc("Гром", 30, 40);
+    
+    NpcStore store;
+    store.add(knight);
+    store.add(orc);
+    
+    ASSERT_EQ(store.size(), 2u);
+    EXPECT_TRUE(knight.isAttached());
+    EXPECT_EQ(orc.getSlot(), 1u);
+    
+    // Изменения в хранилище видны через NPC и наоборот
+    store.x[0] = 55;
+    EXPECT_EQ(knight.getX(), 55);
+    
+    orc.die();
+    EXPECT_EQ(store.alive[1], 0);
+    EXPECT_EQ(store.aliveCount(), 1u);
+    
+    EXPECT_EQ(knight.getName(), "Артур");
+    EXPECT_EQ(store.moveDistance[1], 20.0);
+}
+
+TEST(NpcStoreTest, MoveThroughViewStaysInBounds) {
+    Bear bear("Бурый", 50, 50);
+    NpcStore store;
+    store.add(bear);
+    
+    for (int i = 0; i < 100; i++) {
+        bear.move(100, 100);
+        EXPECT_GE(store.x[0], 0);
+        EXPECT_LE(store.x[0], 100);
+        EXPECT_GE(store.y[0], 0);
+        EXPECT_LE(store.y[0], 100);
+    }
+    EXPECT_EQ(bear.getX(), store.x[0]);
+}
+
+TEST(NpcStoreTest, RemoveDeadMovesLastSlotsIntoHoles) {
+    std::vector<std::shared_ptr<NPC>> owners;
+    NpcStore store;
+    NpcRegistry registry;
+    for (int i = 0; i < 6; i++) {
+        owners.push_back(std::make_shared<Orc>("O" + std::to_string(i), 10 + i, 10));
+        store.add(*owners.back());
+        registry.add(owners.back().get());
+    }
+    NpcHandle lastHandle = owners[5]->getHandle();
+    
+    // Мертвы первый и два последних: на место первого переезжает слот 3
+    owners[0]->die();
+    owners[4]->die();
+    owners[5]->die();
+    std::shared_ptr<NPC> first = owners[0];
+    std::shared_ptr<NPC> moved = owners[3];
+    
+    std::vector<std::shared_ptr<NPC>> removed;
+    EXPECT_EQ(store.removeDead(owners, removed), 3u);
+    ASSERT_EQ(store.size(), 3u);
+    ASSERT_EQ(owners.size(), 3u);
+    EXPECT_EQ(removed.size(), 3u);
+    EXPECT_EQ(store.aliveCount(), 3u);
+    
+    EXPECT_EQ(owners[0], moved);
+    EXPECT_EQ(moved->getSlot(), 0u);
+    EXPECT_EQ(store.x[0], 13);
+    EXPECT_EQ(moved->getName(), "O3");
+    for (uint32_t slot = 0; slot < store.size(); slot++) {
+        EXPECT_EQ(store.views[slot], owners[slot].get());
+        EXPECT_EQ(registry.get(store.handles[slot]), owners[slot].get());
+    }
+    
+    // Отвязанный мертвый NPC сохраняет свое состояние
+    EXPECT_FALSE(first->isAttached());
+    EXPECT_FALSE(first->isAlive());
+    EXPECT_EQ(first->getX(), 10);
+    EXPECT_EQ(first->getName(), "O0");
+    
+    for (const auto& npc : removed) registry.remove(npc->getHandle());
+    EXPECT_EQ(registry.get(lastHandle), nullptr);
+    EXPECT_FALSE(first->getHandle().isValid());
+}
+
+// ==================== ТЕСТЫ ДЛЯ MAP RENDERER ====================
+
+TEST(MapRendererTest, FullFrameCountsCells) {
+    Knight knight("Рыцарь", 5, 5);
+    Orc orc("Орк", 7, 7);
+    Bear bear("Медведь", 100, 100);
+    std::vector<std::unique_ptr<Knight>> crowd;
+    
+    NpcStore store;
+    store.add(knight);
+    store.add(orc);
+    store.add(bear);
+    for (int i = 0; i < 12; i++) {
+        crowd.push_back(std::make_unique<Knight>("Толпа", 55, 15));
+        store.add(*crowd.back());
+    }
+    
+    MapRenderer renderer(100, 100, 4, 2);
+    std::string frame(renderer.compose(store));
+    
+    // Клетки 25x50 метров; NPC на границе карты попадает в крайнюю клетку
+    EXPECT_NE(frame.find("Масштаб: 1 клетка = 25x50 метров"), std::string::npos);
+    EXPECT_NE(frame.find("\n2 . * . \n. . . 1 \n"), std::string::npos);
+    
+    orc.die();
+    frame = renderer.compose(store);
+    EXPECT_NE(frame.find("\n1 . * . \n"), std::string::npos);
+}
+
+TEST(MapRendererTest, DiffModeSendsOnlyChangedCells) {
+    Knight knight("Рыцарь", 5, 5);
+    NpcStore store;
+    store.add(knight);
+    
+    MapRenderer renderer(100, 100, 10, 10, RenderMode::Diff);
+    
+    std::string first(renderer.compose(store));
+    EXPECT_EQ(first.rfind("\x1b[2J", 0), 0u);
+    EXPECT_NE(first.find("Легенда"), std::string::npos);
+    
+    // Без изменений кадр пустой
+    EXPECT_TRUE(renderer.compose(store).empty());
+    
+    // Переход в соседнюю клетку: две клетки, каждая своей ANSI-командой
+    store.x[0] = 15;
+    std::string diff(renderer.compose(store));
+    EXPECT_EQ(diff, "\x1b" "7" "\x1b[4;1H." "\x1b[4;3H1" "\x1b" "8");
+    
+    renderer.invalidate();
+    EXPECT_EQ(std::string(renderer.compose(store)).rfind("\x1b[2J", 0), 0u);
+}
+
+TEST(MapRendererTest, DiffModePinsMapAboveScrollRegion) {
+    Knight knight("Рыцарь", 5, 5);
+    NpcStore store;
+    store.add(knight);
+    
+    // Полный кадр занимает frameLines() строк
+    MapRenderer full(100, 100, 10, 10);
+    std::string plain(full.compose(store));
+    EXPECT_EQ(std::count(plain.begin(), plain.end(), '\n'), full.frameLines());
+    
+    // Прочий вывод прокручивается только под картой, поэтому абсолютные
+    // строки кадров разностей остаются верными после любых сообщений
+    MapRenderer renderer(100, 100, 10, 10, RenderMode::Diff);
+    std::string first(renderer.compose(store));
+    EXPECT_NE(first.find("\x1b[16r\x1b[16;1H"), std::string::npos);
+    
+    EXPECT_EQ(renderer.release().rfind("\x1b[r", 0), 0u);
+    std::string last(renderer.compose(store));
+    EXPECT_EQ(last, plain);
+    EXPECT_TRUE(renderer.release().empty());
+}
+
+// ==================== ТЕСТЫ ДЛЯ BATCH MOVER ====================
+
+TEST(BatchMoverTest, SincosApproximation) {
+    for (double angle = 0.0; angle < 2.0 * M_PI; angle += 0.001) {
+        double s, c;
+        BatchMover::sincos(angle, s, c);
+        EXPECT_NEAR(s, std::sin(angle), 1e-8);
+        EXPECT_NEAR(c, std::cos(angle), 1e-8);
+    }
+}
+
+TEST(BatchMoverTest, BothKernelsRespectBoundsAndDeath) {
+    for (bool allowSimd : {false, true}) {
+        std::vector<std::shared_ptr<NPC>> npcs;
+        NpcStore store;
+        NpcRegistry registry;
+        for (int i = 0; i < 37; i++) {
+            npcs.push_back(std::make_shared<Knight>("K" + std::to_string(i), (i * 7) % 100, (i * 13) % 100));
+            store.add(*npcs.back());
+            registry.add(npcs.back().get());
+        }
+        npcs[5]->die();
+        double deadX = npcs[5]->getX();
+        double deadY = npcs[5]->getY();
+        
+        BatchMover mover(allowSimd);
+        CounterRng rng(7);
+        for (uint32_t tick = 0; tick < 50; tick++) {
+            mover.moveAll(store, rng, tick, 100, 100);
+            for (size_t i = 0; i < store.size(); i++) {
+                ASSERT_GE(store.x[i], 0);
+                ASSERT_LE(store.x[i], 99);
+                ASSERT_GE(store.y[i], 0);
+                ASSERT_LE(store.y[i], 99);
+            }
+        }
+        
+        EXPECT_EQ(npcs[5]->getX(), deadX);
+        EXPECT_EQ(npcs[5]->getY(), deadY);
+    }
+}
+
+TEST(BatchMoverTest, KernelsAreReproducible) {
+    auto run = [](bool allowSimd) {
+        std::vector<std::shared_ptr<NPC>> npcs;
+        NpcStore store;
+        NpcRegistry registry;
+        for (int i = 0; i < 101; i++) {
+            npcs.push_back(std::make_shared<Bear>("B" + std::to_string(i), 50, 50));
+            store.add(*npcs.back());
+            registry.add(npcs.back().get());
+        }
+        
+        BatchMover mover(allowSimd);
+        CounterRng rng(12345);
+        for (uint32_t tick = 1; tick <= 20; tick++) {
+            mover.moveAll(store, rng, tick, 100, 100);
+        }
+        return store.x;
+    };
+    
+    std::vector<double> scalar = run(false);
+    std::vector<double> simd = run(true);
+    
+    ASSERT_EQ(scalar.size(), simd.size());
+    for (size_t i = 0; i < scalar.size(); i++) {
+        EXPECT_DOUBLE_EQ(scalar[i], simd[i]);
+    }
+    EXPECT_EQ(run(false), scalar);
+}
+
+TEST(BatchMoverTest, PoolSplitMatchesSerial) {
+    auto run = [](ThreadPool* pool) {
+        std::vector<std::shared_ptr<NPC>> npcs;
+        NpcStore store;
+        for (int i = 0; i < 5000; i++) {
+            npcs.push_back(std::make_shared<Orc>("O", i % 100, (i / 100) % 100));
+            store.add(*npcs.back());
+        }
+        npcs[7]->die();
+        
+        BatchMover mover;
+        CounterRng rng(77);
+        for (uint32_t tick = 1; tick <= 10; tick++) {
+            if (pool) {
+                mover.moveAll(store, rng, tick, 100, 100, *pool);
+            } else {
+                mover.moveAll(store, rng, tick, 100, 100);
+            }
+        }
+        return std::make_pair(store.x, store.y);
+    };
+    
+    ThreadPool pool(4);
+    EXPECT_EQ(run(&pool), run(nullptr));
+}
+
+// ==================== ТЕСТЫ ДЛЯ COUNTER RNG ====================
+
+TEST(CounterRngTest, StatelessAndKeyed) {
+    CounterRng rng(42);
+    
+    // Одни и те же ключи дают одно и то же число, порядок вызовов не важен
+    EXPECT_EQ(rng.next(1, 10, RngPurpose::AttackDice), rng.next(1, 10, RngPurpose::AttackDice));
+    EXPECT_NE(rng.next(1, 10, RngPurpose::AttackDice), rng.next(2, 10, RngPurpose::AttackDice));
+    EXPECT_NE(rng.next(1, 10, RngPurpose::AttackDice), rng.next(1, 11, RngPurpose::AttackDice));
+    EXPECT_NE(rng.next(1, 10, RngPurpose::AttackDice), rng.next(1, 10, RngPurpose::DefenseDice));
+    EXPECT_NE(rng.next(1, 10, RngPurpose::AttackDice), CounterRng(43).next(1, 10, RngPurpose::AttackDice));
+}
+
+TEST(CounterRngTest, DiceDistribution) {
+    CounterRng rng(2024);
+    std::vector<int> counts(7, 0);
+    const int ROLLS = 60000;
+    
+    for (int i = 0; i < ROLLS; i++) {
+        int value = rng.dice(i, 0, RngPurpose::AttackDice);
+        ASSERT_GE(value, 1);
+        ASSERT_LE(value, 6);
+        counts[value]++;
+    }
+    
+    for (int face = 1; face <= 6; face++) {
+        EXPECT_NEAR(counts[face], ROLLS / 6, ROLLS / 60);
+    }
+    
+    for (int i = 0; i < 1000; i++) {
+        double u = rng.uniform(i, 3, RngPurpose::MoveDirection);
+        EXPECT_GE(u, 0.0);
+        EXPECT_LT(u, 1.0);
+    }
+}
+
+// ==================== ТЕСТЫ ДЛЯ АЛЛОКАТОРОВ ====================
+
+TEST(AllocatorTest, SlabArenaBumpsReusesAndMapsLargeObjects) {
+    SlabArena arena(64 * 1024);
+    
+    void* a = arena.allocate(24);
+    void* b = arena.allocate(24);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % SlabArena::ALIGNMENT, 0u);
+    EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 32);
+    
+    // Освобожденная ячейка возвращается следующему объекту того же класса
+    arena.deallocate(a, 24);
+    EXPECT_EQ(arena.allocate(20), a);
+    
+    // Крупный объект получает свое отображение
+    size_t blocks = arena.blockCount();
+    void* big = arena.allocate(100 * 1024);
+    ASSERT_NE(big, nullptr);
+    std::memset(big, 0xAB, 100 * 1024);
+    EXPECT_EQ(arena.blockCount(), blocks + 1);
+    
+    EXPECT_THROW(arena.allocate(16, 64), std::invalid_argument);
+}
+
+TEST(AllocatorTest, SlabArenaIsSafeAcrossThreads) {
+    SlabArena arena(16 * 1024);
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 5000;
+    std::vector<std::vector<void*>> results(THREADS);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&arena, &results, t]() {
+            for (int i = 0; i < PER_THREAD; i++) {
+                void* p = arena.allocate(48);
+                std::memset(p, t, 48);
+                results[t].push_back(p);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    std::vector<void*> all;
+    for (auto& part : results) all.insert(all.end(), part.begin(), part.end());
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+    for (int t = 0; t < THREADS; t++) {
+        EXPECT_EQ(*static_cast<unsigned char*>(results[t].back()), t);
+    }
+}
+
+TEST(AllocatorTest, FactoryPlacesSharedNpcsInArena) {
+    SlabArena arena;
+    arena.reserve(10000 * NPCFactory::ARENA_BYTES_PER_NPC);
+    size_t blocks = arena.blockCount();
+    
+    NameId name = NameTable::global().intern("N");
+    std::vector<std::shared_ptr<NPC>> npcs;
+    for (int i = 0; i < 10000; i++) {
+        npcs.push_back(NPCFactory::createShared(static_cast<NpcKind>(i % 3), name, 10, 10, arena));
+    }
+    EXPECT_EQ(npcs[1]->getType(), "Orc");
+    EXPECT_EQ(npcs[2]->getName(), "N");
+    // Десять тысяч объектов с блоками управления - без единого нового отображения
+    EXPECT_EQ(arena.blockCount(), blocks);
+    
+    NPC* released = npcs.back().get();
+    npcs.pop_back();
+    auto reused = NPCFactory::createShared(NpcKind::Orc, NameId::generated(NpcKind::Orc, 1), 20, 20, arena);
+    EXPECT_EQ(static_cast<void*>(reused.get()), static_cast<void*>(released));
+    
+    // GameManager размещает своих NPC в собственной арене
+    SimulationConfig config;
+    config.npcCount = 20000;
+    config.mapWidth = config.mapHeight = 2000;
+    config.headless = true;
+    config.seed = 1;
+    GameManager game(config);
+    EXPECT_EQ(game.getReport().deaths, 0u);
+}
+
+TEST(AllocatorTest, NodePoolRecyclesSetNodesBetweenTicks) {
+    NodePool pool;
+    std::unordered_set<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, PoolAllocator<uint64_t>>
+        pairs(0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{}, PoolAllocator<uint64_t>(pool));
+    
+    for (uint64_t i = 0; i < 5000; i++) pairs.insert(i);
+    size_t chunks = pool.chunkCount();
+    EXPECT_GE(chunks, 1u);
+    
+    // Следующие тики берут узлы из пула, не запрашивая новых кусков
+    for (int tick = 0; tick < 5; tick++) {
+        pairs.clear();
+        for (uint64_t i = 0; i < 5000; i++) pairs.insert(i * 7 + tick);
+        EXPECT_EQ(pairs.size(), 5000u);
+    }
+    EXPECT_EQ(pool.chunkCount(), chunks);
+}
+
+// ==================== ТЕСТЫ ДЛЯ ТАБЛИЦЫ ИМЕН ====================
+
+TEST(NameTableTest, InternDeduplicatesAndKeepsViewsStable) {
+    NameTable table;
+    NameId first = table.intern("Артур");
+    std::string_view text = table.view(first);
+    
+    EXPECT_EQ(table.intern(std::string("Артур")), first);
+    EXPECT_NE(table.intern("Мерлин"), first);
+    EXPECT_EQ(table.intern(""), NameId{});
+    EXPECT_EQ(table.internedCount(), 2u);
+    
+    // Рост таблицы не сдвигает уже выданные строки
+    for (int i = 0; i < 20000; i++) table.intern("Имя_" + std::to_string(i));
+    EXPECT_EQ(text.data(), table.view(first).data());
+    EXPECT_EQ(table.view(first), "Артур");
+}
+
+TEST(NameTableTest, GeneratedNamesMaterializeOnlyWhenShown) {
+    NameTable table;
+    NameId orc = NameId::generated(NpcKind::Orc, 42);
+    EXPECT_TRUE(orc.isGenerated());
+    EXPECT_EQ(orc.kind(), NpcKind::Orc);
+    EXPECT_EQ(orc.index(), 42u);
+    
+    NameBuffer buffer;
+    EXPECT_EQ(table.format(orc, buffer), "Орк_42");
+    EXPECT_EQ(table.generatedShown(), 0u);
+    
+    std::string_view shown = table.view(orc);
+    EXPECT_EQ(shown, "Орк_42");
+    EXPECT_EQ(table.view(orc).data(), shown.data());
+    EXPECT_EQ(table.generatedShown(), 1u);
+    EXPECT_EQ(table.format(NameId::generated(NpcKind::Bear, 7), buffer), "Медведь_7");
+}
+
+TEST(NameTableTest, NpcKeepsCompactNameId) {
+    Knight named("Ланселот", 10, 10);
+    Knight generated(NameId::generated(NpcKind::Knight, 3), 10, 10);
+    EXPECT_EQ(named.getName(), "Ланселот");
+    EXPECT_EQ(generated.getName(), "Рыцарь_3");
+    EXPECT_EQ(named.getNameId(), NameTable::global().intern("Ланселот"));
+    
+    // Снимок мира копирует идентификаторы имен вместе с остальными столбцами
+    NpcStore store, copy;
+    store.add(named);
+    store.add(generated);
+    copy.copyStateFrom(store);
+    EXPECT_EQ(copy.names, store.names);
+    EXPECT_EQ(generated.getName(), "Рыцарь_3");
+}
+
+// ==================== ТЕСТЫ ДЛЯ FIGHT QUEUE ====================
+
+static FightTask makeTask(uint32_t a, uint32_t b) {
+    return FightTask{NpcHandle{a, 0}, NpcHandle{b, 0}};
+}
+
+TEST(FightQueueTest, BatchPushPopKeepsOrder) {
+    FightQueue queue(8, BackpressurePolicy::Block);
+    std::vector<FightTask> in = {makeTask(1, 2), makeTask(3, 4), makeTask(5, 6)};
+    
+    EXPECT_EQ(queue.pushBatch(in.data(), in.size()), 3u);
+    EXPECT_EQ(queue.depth(), 3u);
+    
+    std::vector<FightTask> out(8);
+    ASSERT_EQ(queue.popBatch(out.data(), out.size()), 3u);
+    EXPECT_EQ(out[0].attacker.index, 1u);
+    EXPECT_EQ(out[2].defender.index, 6u);
+    EXPECT_EQ(queue.depth(), 0u);
+}
+
+TEST(FightQueueTest, BackpressurePolicies) {
+    std::vector<FightTask> tasks;
+    for (uint32_t i = 0; i < 6; i++) tasks.push_back(makeTask(i, i));
+    std::vector<FightTask> out(8);
+    
+    // DropOldest: остаются последние задачи
+    FightQueue dropOldest(4, BackpressurePolicy::DropOldest);
+    dropOldest.pushBatch(tasks.data(), tasks.size());
+    EXPECT_EQ(dropOldest.depth(), 4u);
+    EXPECT_EQ(dropOldest.dropped(), 2u);
+    ASSERT_EQ(dropOldest.popBatch(out.data(), out.size()), 4u);
+    EXPECT_EQ(out[0].attacker.index, 2u);
+    
+    // DropNewest: новые задачи при переполнении отбрасываются
+    FightQueue dropNewest(4, BackpressurePolicy::DropNewest);
+    EXPECT_EQ(dropNewest.pushBatch(tasks.data(), tasks.size()), 4u);
+    EXPECT_EQ(dropNewest.dropped(), 2u);
+    ASSERT_EQ(dropNewest.popBatch(out.data(), out.size()), 4u);
+    EXPECT_EQ(out[3].attacker.index, 3u);
+}
+
+TEST(FightQueueTest, ConcurrentProducersAndConsumers) {
+    FightQueue queue(64, BackpressurePolicy::Block);
+    const int PRODUCERS = 4;
+    const int PER_PRODUCER = 5000;
+    std::atomic<int> consumed{0};
+    std::atomic<uint64_t> checksum{0};
+    
+    std::vector<std::thread> threads;
+    for (int c = 0; c < 2; c++) {
+        threads.emplace_back([&]() {
+            std::vector<FightTask> out(16);
+            while (consumed < PRODUCERS * PER_PRODUCER) {
+                size_t count = queue.popBatch(out.data(), out.size());
+                for (size_t i = 0; i < count; i++) checksum += out[i].attacker.index;
+                consumed += static_cast<int>(count);
+                if (count == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (int p = 0; p < PRODUCERS; p++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < PER_PRODUCER; i += 10) {
+                std::vector<FightTask> batch;
+                for (int j = i; j < i + 10; j++) batch.push_back(makeTask(j, 0));
+                queue.pushBatch(batch.data(), batch.size());
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    
+    uint64_t expected = static_cast<uint64_t>(PRODUCERS) * PER_PRODUCER * (PER_PRODUCER - 1) / 2;
+    EXPECT_EQ(checksum, expected);
+    EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// ==================== ТЕСТЫ ДЛЯ THREAD POOL ====================
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndex) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    
+    for (int round = 0; round < 10; round++) {
+        pool.parallelFor(hits.size(), [&](size_t i) { hits[i]++; });
+    }
+    
+    for (auto& h : hits) {
+        EXPECT_EQ(h.load(), 10);
+    }
+}
+
+// ==================== ТЕСТЫ ДЛЯ FIGHT RESOLVER ====================
+
+// Мир из групп NPC, стоящих вплотную: у каждого NPC несколько соперников
+struct FightWorld {
+    std::vector<std::shared_ptr<NPC>> npcs;
+    NpcStore store;
+    NpcRegistry registry;
+    std::vector<FightTask> tasks;
+    
+    explicit FightWorld(int groups) {
+        for (int g = 0; g < groups; g++) {
+            double x = 1 + (g % 400) * 12.0;
+            double y = 1 + (g / 400) * 12.0;
+            npcs.push_back(std::make_shared<Knight>("K", x, y));
+            npcs.push_back(std::make_shared<Orc>("O", x + 1, y));
+            npcs.push_back(std::make_shared<Bear>("B", x, y + 1));
+        }
+        store.reserve(npcs.size());
+        for (auto& npc : npcs) {
+            store.add(*npc);
+            registry.add(npc.get());
+        }
+        for (size_t i = 0; i < npcs.size(); i += 3) {
+            for (size_t a = i; a < i + 3; a++) {
+                for (size_t b = i; b < i + 3; b++) {
+                    if (a < b) tasks.push_back(FightTask{npcs[a]->getHandle(), npcs[b]->getHandle(), 1});
+                }
+            }
+        }
+    }
+};
+
+TEST(FightResolverTest, ResultDoesNotDependOnThreadCount) {
+    auto run = [](size_t threads) {
+        FightWorld world(500);
+        std::vector<std::shared_ptr<DeathObserver>> observers;
+        FightQueue queue(16, BackpressurePolicy::DropNewest);
+        SpatialGrid grid(5000, 5000, 10);
+        BattleVisitor visitor(10.0, world.store, grid, observers, queue);
+        
+        ThreadPool pool(threads);
+        FightResolver resolver(pool, 10.0);
+        CounterRng rng(99);
+        
+        size_t resolved = resolver.resolve(world.tasks.data(), world.tasks.size(), world.registry, visitor, rng, 1);
+        EXPECT_EQ(resolved, world.tasks.size());
+        EXPECT_GE(resolver.getColorCount(), 3u);
+        return world.store.alive;
+    };
+    
+    std::vector<uint8_t> single = run(1);
+    std::vector<uint8_t> parallel = run(4);
+    
+    EXPECT_EQ(single, parallel);
+    EXPECT_LT(std::count(single.begin(), single.end(), 1), static_cast<long>(single.size()));
+}
+
+TEST(FightResolverTest, DropsStaleTasks) {
+    FightWorld world(10);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(16, BackpressurePolicy::DropNewest);
+    SpatialGrid grid(500, 500, 10);
+    BattleVisitor visitor(10.0, world.store, grid, observers, queue);
+    
+    ThreadPool pool(1);
+    FightResolver resolver(pool, 10.0);
+    CounterRng rng(1);
+    
+    // Задачи помечены тиком 1, а текущий тик уже 2
+    EXPECT_EQ(resolver.resolve(world.tasks.data(), world.tasks.size(), world.registry, visitor, rng, 2), 0u);
+    EXPECT_EQ(resolver.getStaleDropped(), world.tasks.size());
+    EXPECT_EQ(world.store.aliveCount(), world.store.size());
+}
+
+TEST(FightResolverTest, UsesConfiguredFightRange) {
+    Knight knight("K", 10, 10);
+    Orc orc("O", 30, 10);   // 20 м
+    NpcStore store;
+    NpcRegistry registry;
+    for (NPC* npc : {static_cast<NPC*>(&knight), static_cast<NPC*>(&orc)}) {
+        store.add(*npc);
+        registry.add(npc);
+    }
+    EXPECT_FALSE(knight.isInKillingRange(orc));
+    EXPECT_TRUE(knight.isInKillingRange(orc, 25.0));
+    
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(16, BackpressurePolicy::DropNewest);
+    SpatialGrid grid(100, 100, 25);
+    BattleVisitor visitor(25.0, store, grid, observers, queue);
+    ThreadPool pool(1);
+    CounterRng rng(3);
+    FightTask task{knight.getHandle(), orc.getHandle(), 1};
+    
+    FightResolver shortRange(pool, 10.0);
+    EXPECT_EQ(shortRange.resolve(&task, 1, registry, visitor, rng, 1), 0u);
+    FightResolver longRange(pool, 25.0);
+    EXPECT_EQ(longRange.resolve(&task, 1, registry, visitor, rng, 1), 1u);
+}
+
+TEST(FightResolverTest, VisitorDeduplicatesPairsPerTick) {
+    FightWorld world(3);
+    SpatialGrid grid(500, 500, 10);
+    grid.rebuild(world.store);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(64, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(10.0, world.store, grid, observers, queue);
+    
+    for (uint32_t tick = 1; tick <= 2; tick++) {
+        visitor.beginTick(tick);
+        for (int repeat = 0; repeat < 2; repeat++) {
+            for (uint32_t i = 0; i < world.store.size(); i++) visitor.visit(i);
+        }
+        visitor.flush();
+    }
+    
+    // 3 группы по 3 пары, по одному разу на каждый из двух тиков
+    std::vector<FightTask> out(64);
+    ASSERT_EQ(queue.popBatch(out.data(), out.size()), 18u);
+    EXPECT_EQ(out[0].tick, 1u);
+    EXPECT_EQ(out[17].tick, 2u);
+}
+
+// ==================== ТЕСТЫ ДЛЯ WORLD SNAPSHOTS ====================
+
+TEST(WorldSnapshotTest, ReaderKeepsFrameWhileWriterPublishes) {
+    Knight knight("K", 10, 10);
+    Orc orc("O", 20, 20);
+    NpcStore store;
+    store.add(knight);
+    store.add(orc);
+    
+    WorldSnapshots snapshots;
+    EXPECT_FALSE(snapshots.read().valid());
+    
+    ASSERT_TRUE(snapshots.publish(store, 1));
+    auto first = snapshots.read();
+    ASSERT_TRUE(first.valid());
+    
+    store.x[0] = 50;
+    orc.die();
+    for (uint32_t tick = 2; tick < 10; tick++) {
+        EXPECT_TRUE(snapshots.publish(store, tick));
+    }
+    
+    // Старый кадр не перезаписан, пока его держит читатель
+    EXPECT_EQ(first->tick, 1u);
+    EXPECT_EQ(first->npcs.x[0], 10);
+    EXPECT_EQ(first->aliveCount, 2u);
+    
+    auto latest = snapshots.read();
+    EXPECT_EQ(latest->tick, 9u);
+    EXPECT_EQ(latest->npcs.x[0], 50);
+    EXPECT_EQ(latest->aliveCount, 1u);
+}
+
+TEST(WorldSnapshotTest, PublishSkipsWhenAllFramesAreRead) {
+    Bear bear("B", 5, 5);
+    NpcStore store;
+    store.add(bear);
+    
+    WorldSnapshots snapshots;
+    std::vector<WorldSnapshots::Reader> readers;
+    uint32_t tick = 0;
+    while (snapshots.publish(store, ++tick)) {
+        readers.push_back(snapshots.read());
+        ASSERT_LT(tick, 100u);
+    }
+    
+    EXPECT_EQ(snapshots.skipped(), 1u);
+    EXPECT_EQ(snapshots.read()->tick, tick - 1);
+    
+    readers.clear();
+    EXPECT_TRUE(snapshots.publish(store, ++tick));
+}
+
+TEST(WorldSnapshotTest, ConcurrentReadersSeeConsistentFrames) {
+    std::vector<std::shared_ptr<NPC>> npcs;
+    NpcStore store;
+    for (int i = 0; i < 64; i++) {
+        npcs.push_back(std::make_shared<Knight>("K", 1, 1));
+        store.add(*npcs.back());
+    }
+    
+    WorldSnapshots snapshots;
+    snapshots.publish(store, 0);
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                auto frame = snapshots.read();
+                // Все координаты кадра записаны на одном тике
+                for (double x : frame->npcs.x) {
+                    if (x != static_cast<double>(frame->tick % 90 + 1)) torn++;
+                }
+            }
+        });
+    }
+    
+    for (uint32_t tick = 1; tick < 5000; tick++) {
+        std::fill(store.x.begin(), store.x.end(), static_cast<double>(tick % 90 + 1));
+        snapshots.publish(store, tick);
+    }
+    done = true;
+    for (auto& t : readers) t.join();
+    
+    EXPECT_EQ(torn, 0);
+}
+
+// ==================== ТЕСТЫ ДЛЯ NPC REGISTRY ====================
+
+TEST(NpcRegistryTest, ResolvesHandles) {
+    Knight knight("K", 10, 10);
+    Orc orc("O", 20, 20);
+    
+    NpcRegistry registry;
+    NpcHandle k = registry.add(&knight);
+    NpcHandle o = registry.add(&orc);
+    
+    EXPECT_EQ(knight.getHandle(), k);
+    EXPECT_EQ(registry.get(k), &knight);
+    EXPECT_EQ(registry.get(o), &orc);
+    EXPECT_EQ(registry.get(NpcHandle{}), nullptr);
+}
+
+TEST(NpcRegistryTest, StaleHandleAfterRemoval) {
+    Knight k1("K1", 10, 10);
+    Knight k2("K2", 20, 20);
+    
+    NpcRegistry registry;
+    NpcHandle first = registry.add(&k1);
+    registry.remove(first);
+    
+    EXPECT_EQ(registry.get(first), nullptr);
+    EXPECT_FALSE(k1.getHandle().isValid());
+    
+    // Индекс переиспользуется, но старый handle остается недействительным
+    NpcHandle second = registry.add(&k2);
+    EXPECT_EQ(second.index, first.index);
+    EXPECT_NE(second.generation, first.generation);
+    EXPECT_EQ(registry.get(first), nullptr);
+    EXPECT_EQ(registry.get(second), &k2);
+}
+
+// ==================== ТЕСТЫ ДЛЯ SPATIAL GRID ====================
+
+TEST(SpatialGridTest, FindsOnlyNeighbourCells) {
+    std::vector<std::shared_ptr<NPC>> npcs = {
+        std::make_shared<Knight>("K1", 5, 5),
+        std::make_shared<Orc>("O1", 12, 5),    // соседняя клетка
+        std::make_shared<Bear>("B1", 55, 55),  // далеко
+    };
+    
+    NpcStore store;
+    for (auto& npc : npcs) store.add(*npc);
+    
+    SpatialGrid grid(100, 100, 10);
+    grid.rebuild(store);
+    
+    std::vector<int> found;
+    grid.forEachNeighbour(grid.cellCol(5), grid.cellRow(5), [&](int index) {
+        found.push_back(index);
+    });
+    std::sort(found.begin(), found.end());
+    
+    EXPECT_EQ(found, (std::vector<int>{0, 1}));
+}
+
+TEST(SpatialGridTest, VisitorMatchesBruteForce) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> pos(0.0, 99.0);
+    
+    std::vector<std::shared_ptr<NPC>> npcs;
+    for (int i = 0; i < 300; i++) {
+        std::string type = i % 3 == 0 ? "Knight" : (i % 3 == 1 ? "Orc" : "Bear");
+        npcs.push_back(NPCFactory::createNPC(type, "N" + std::to_string(i), pos(gen) + 1, pos(gen) + 1));
+    }
+    npcs[7]->die();
+    
+    NpcStore store;
+    NpcRegistry registry;
+    for (auto& npc : npcs) {
+        store.add(*npc);
+        registry.add(npc.get());
+    }
+    
+    SpatialGrid grid(100, 100, 10);
+    grid.rebuild(store);
+    
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    FightQueue queue(1 << 16, BackpressurePolicy::DropNewest);
+    BattleVisitor visitor(10.0, store, grid, observers, queue);
+    
+    size_t expected = 0;
+    visitor.beginTick(1);
+    for (auto& a : npcs) {
+        if (!a->isAlive()) continue;
+        visitor.visit(*a);
+        for (auto& b : npcs) {
+            if (a == b || !b->isAlive() || a->distanceTo(*b) > 10.0) continue;
+            if (a->canDefeat(*b) || b->canDefeat(*a)) expected++;
+        }
+    }
+    visitor.flush();
+    
+    // Каждая неупорядоченная пара попадает в очередь один раз за тик
+    EXPECT_EQ(queue.depth(), expected / 2);
+    EXPECT_EQ(queue.dropped(), 0u);
+}
+
+TEST(SpatialGridTest, ForEachWithinCoversRadiusWiderThanCell) {
+    std::vector<std::shared_ptr<NPC>> npcs = {
+        std::make_shared<Knight>("K1", 50, 50),
+        std::make_shared<Orc>("O1", 72, 50),   // через клетку
+        std::make_shared<Bear>("B1", 95, 95),  // дальше радиуса
+    };
+    
+    NpcStore store;
+    for (auto& npc : npcs) store.add(*npc);
+    
+    SpatialGrid grid(100, 100, 10);
+    grid.rebuild(store);
+    
+    std::vector<int> found;
+    grid.forEachWithin(50, 50, 25, [&](int index) { found.push_back(index); });
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<int>{0, 1}));
+    
+    found.clear();
+    grid.forEachNeighbour(grid.cellCol(50), grid.cellRow(50), [&](int index) { found.push_back(index); });
+    EXPECT_EQ(found, (std::vector<int>{0}));
+}
+
+TEST(SpatialGridTest, ParallelVisitMatchesSerial) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<> pos(1.0, 299.0);
+    
+    std::vector<std::shared_ptr<NPC>> npcs;
+    NpcStore store;
+    NpcRegistry registry;
+    for (int i = 0; i < 5000; i++) {
+        std::string type = i % 3 == 0 ? "Knight" : (i % 3 == 1 ? "Orc" : "Bear");
+        npcs.push_back(NPCFactory::createNPC(type, "N", pos(gen), pos(gen)));
+        store.add(*npcs.back());
+        registry.add(npcs.back().get());
+    }
+    
+    SpatialGrid grid(300, 300, 10);
+    grid.rebuild(store);
+    std::vector<std::shared_ptr<DeathObserver>> observers;
+    
+    auto collect = [&](bool parallel) {
+        FightQueue queue(1 << 16, BackpressurePolicy::DropNewest);
+        BattleVisitor visitor(10.0, store, grid, observers, queue);
+        visitor.beginTick(1);
+        
+        ThreadPool pool(4);
+        if (parallel) {
+            visitor.visitAll(pool);
+        } else {
+            for (uint32_t i = 0; i < store.size(); i++) visitor.visit(i);
+            visitor.flush();
+        }
+        
+        std::vector<FightTask> tasks(queue.depth());
+        tasks.resize(queue.popBatch(tasks.data(), tasks.size()));
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (auto& task : tasks) {
+            pairs.emplace_back(std::min(task.attacker.index, task.defender.index),
+                               std::max(task.attacker.index, task.defender.index));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    };
+    
+    auto serial = collect(false);
+    EXPECT_FALSE(serial.empty());
+    EXPECT_EQ(serial, collect(true));
+}
+
+TEST(SpatialGridTest, CandidatesPerNpcStayFlatAtFixedDensity) {
+    // Плотность NPC постоянна: карта растет вместе с N. При линейной
+    // сложности число кандидатов на один NPC от N не зависит.
+    auto candidatesPerNpc = [](int count) {
+        double side = std::sqrt(static_cast<double>(count)) * 10.0;
+        std::mt19937 gen(count);
+        std::uniform_real_distribution<> pos(0.0, side - 1.0);
+        
+        std::vector<std::unique_ptr<Knight>> npcs;
+        NpcStore store;
+        store.reserve(count);
+        for (int i = 0; i < count; i++) {
+            npcs.push_back(std::make_unique<Knight>("K", pos(gen), pos(gen)));
+            store.add(*npcs.back());
+        }
+        
+        SpatialGrid grid(side, side, 10.0);
+        grid.rebuild(store);
+        size_t visited = 0;
+        for (uint32_t i = 0; i < store.size(); i++) {
+            grid.forEachNeighbour(grid.cellCol(store.x[i]), grid.cellRow(store.y[i]), [&](int) { visited++; });
+        }
+        return static_cast<double>(visited) / count;
+    };
+    
+    double small = candidatesPerNpc(2000);
+    double large = candidatesPerNpc(32000);
+    
+    // Девять клеток по 100 м2 при одном NPC на 100 м2; при O(N^2) было бы ~N
+    EXPECT_LT(large, 10.0);
+    EXPECT_LT(large, small * 1.2);
+}
+
+// ==================== ТЕСТЫ ДЛЯ СПИСКОВ СОСЕДЕЙ ====================
+
+TEST(NeighbourListsTest, MatchBruteForceWhileNpcsMoveAndDie) {
+    constexpr double RANGE = 10.0;
+    constexpr double SIDE = 200.0;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<> pos(1.0, SIDE - 1.0);
+    std::uniform_real_distribution<> step(-1.5, 1.5);
+    
+    std::vector<std::shared_ptr<NPC>> owners;
+    NpcStore store;
+    NpcRegistry registry;
+    for (int i = 0; i < 600; i++) {
+        owners.push_back(NPCFactory::createNPC(static_cast<NpcKind>(i % 3), NameId{}, pos(gen), pos(gen)));
+        store.add(*owners.back());
+        registry.add(owners.back().get());
+    }
+    
+    SpatialGrid grid(SIDE, SIDE, RANGE);
+    NeighbourLists lists(RANGE, 8.0);
+    std::vector<std::shared_ptr<NPC>> removed;
+    size_t rebuilds = 0;
+    
+    for (int tick = 0; tick < 40; tick++) {
+        if (tick > 0) rebuilds += lists.prepare(store);
+        else lists.prepare(store);
+        grid.rebuild(store);
+        
+        std::set<std::pair<uint32_t, uint32_t>> cached, expected;
+        for (uint32_t a = 0; a < store.size(); a++) {
+            if (!store.alive[a]) continue;
+            lists.forEachCandidate(a, store, grid, [&](uint32_t b) {
+                cached.insert({std::min(a, b), std::max(a, b)});
+            });
+            for (uint32_t b = a + 1; b < store.size(); b++) {
+                if (!store.alive[b] || !canFight(store.type[a], store.type[b])) continue;
+                double dx = store.x[a] - store.x[b], dy = store.y[a] - store.y[b];
+                if (dx * dx + dy * dy <= RANGE * RANGE) expected.insert({a, b});
+            }
+        }
+        ASSERT_EQ(cached, expected) << "тик " << tick;
+        
+        // Шаг, несколько смертей и уплотнение, как в конце тика мира
+        for (uint32_t slot = 0; slot < store.size(); slot++) {
+            store.x[slot] = std::clamp(store.x[slot] + step(gen), 0.0, SIDE);
+            store.y[slot] = std::clamp(store.y[slot] + step(gen), 0.0, SIDE);
+        }
+        for (int k = 0; k < 5; k++) {
+            store.views[gen() % store.size()]->die();
+        }
+        store.removeDead(owners, removed);
+        for (const auto& npc : removed) registry.remove(npc->getHandle());
+        removed.clear();
+    }
+    
+    // Путь до 2 м за тик при запасе 8 м: список живет минимум два тика
+    EXPECT_GT(rebuilds, 0u);
+    EXPECT_LT(rebuilds, 600u * 39 / 2);
+}
+
+TEST(NeighbourListsTest, SimulationRunsWithSkin) {
+    const char* argv[] = {"main", "--npcs", "1500", "--width", "400", "--height", "400", "--neighbour-skin", "6",
+                          "--threads", "2", "--seed", "4", "--headless", "--ticks", "60",
+                          "--metrics", "--metrics-file", "neighbour_test.prom"};
+    SimulationConfig config = SimulationConfig::fromArgs(19, argv);
+    EXPECT_EQ(config.neighbourSkin, 6.0);
+    
+    GameManager game(config);
+    game.runTicks(60);
+    SimulationReport report = game.getReport();
+    EXPECT_GT(report.fights, 0u);
+    EXPECT_GT(report.deaths, 0u);
+    EXPECT_EQ(game.getStoredNpcCount(), 1500u - report.deaths);
+    EXPECT_LT(game.getMetrics()->getGauge(Gauge::NeighbourRebuilds), static_cast<int64_t>(game.getStoredNpcCount()));
+    std::filesystem::remove("neighbour_test.prom");
+}
+
 // ==================== ТЕСТЫ ДЛЯ FACTORY ====================
 
 TEST(FactoryTest, CreateNPC) {
@@ -151,6 +1226,167 @@ TEST(FactoryTest, LoadFromInvalidString) {
     EXPECT_EQ(npc3, nullptr);
 }
 
+// ==================== ТЕСТЫ ДЛЯ SCENARIO LOADER ====================
+
+TEST(ScenarioLoaderTest, ParsesTextAndReportsBadLines) {
+    ThreadPool pool(2);
+    std::string text =
+        "Knight Артур 10 20\n"
+        "\n"
+        "# комментарий\n"
+        "Dragon Смауг 5 5\n"
+        "Orc Гром 1.5 2.5\r\n"
+        "Bear Миша 600 10\n"
+        "Orc Без_координат\n"
+        "Bear Топтыгин 3e1 4";
+    
+    ScenarioData data = ScenarioLoader::parseText(text, 500.0, 500.0, pool);
+    ASSERT_EQ(data.size(), 3u);
+    EXPECT_EQ(data.names[0], "Артур");
+    EXPECT_EQ(data.kinds[1], NpcKind::Orc);
+    EXPECT_DOUBLE_EQ(data.y[1], 2.5);
+    EXPECT_DOUBLE_EQ(data.x[2], 30.0);
+    EXPECT_EQ(data.rejected, 3u);
+    ASSERT_EQ(data.errors.size(), 3u);
+    EXPECT_EQ(data.errors[0].rfind("строка 4:", 0), 0u);
+}
+
+TEST(ScenarioLoaderTest, ChunkedParseKeepsFileOrder) {
+    // Несколько кусков по 64 КБ: порядок и результат не зависят от размера пула
+    std::string text;
+    for (int i = 0; i < 20000; i++) {
+        text += std::string(NPC_KIND_NAMES[i % 3]) + " N" + std::to_string(i) + " " +
+                std::to_string(1 + i % 400) + " " + std::to_string(1 + i % 300) + "\n";
+        if (i % 1000 == 0) text += "broken line\n";
+    }
+    
+    ThreadPool single(1);
+    ThreadPool wide(4);
+    ScenarioData serial = ScenarioLoader::parseText(text, 500.0, 500.0, single);
+    ScenarioData parallel = ScenarioLoader::parseText(text, 500.0, 500.0, wide);
+    
+    ASSERT_EQ(parallel.size(), 20000u);
+    EXPECT_EQ(parallel.rejected, 20u);
+    EXPECT_EQ(parallel.names, serial.names);
+    EXPECT_EQ(parallel.x, serial.x);
+    EXPECT_EQ(parallel.names[12345], "N12345");
+    EXPECT_DOUBLE_EQ(parallel.y[12345], 1 + 12345 % 300);
+}
+
+TEST(ScenarioLoaderTest, SnapshotRoundTripAndPopulate) {
+    const char* textPath = "test_scenario.txt";
+    const char* snapshotPath = "test_scenario.bin";
+    {
+        std::ofstream out(textPath);
+        out << "Knight Ланселот 10 10\nOrc Азог 20 20\nBear Балу 30 30\n";
+    }
+    
+    ThreadPool pool(2);
+    NpcStore store;
+    NpcRegistry registry;
+    std::vector<std::shared_ptr<NPC>> npcs;
+    ScenarioLoader::populate(ScenarioLoader::load(textPath, 500.0, 500.0, pool), store, registry, npcs, pool);
+    
+    ASSERT_EQ(npcs.size(), 3u);
+    EXPECT_EQ(npcs[1]->getName(), "Азог");
+    EXPECT_EQ(npcs[1]->getType(), "Orc");
+    EXPECT_EQ(npcs[2]->getRngId(), 2u);
+    EXPECT_EQ(registry.get(npcs[0]->getHandle()), npcs[0].get());
+    EXPECT_DOUBLE_EQ(store.moveDistance[2], 5.0);
+    
+    // Мертвые в снимок не попадают
+    npcs[0]->die();
+    ASSERT_TRUE(ScenarioLoader::saveSnapshot(snapshotPath, store, 500.0, 500.0, 7));
+    ScenarioData loaded = ScenarioLoader::load(snapshotPath, 500.0, 500.0, pool);
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded.names[0], "Азог");
+    EXPECT_EQ(loaded.kinds[1], NpcKind::Bear);
+    EXPECT_DOUBLE_EQ(loaded.x[1], 30.0);
+    
+    // Снимок с карты большего размера отсекается по координатам
+    EXPECT_EQ(ScenarioLoader::loadSnapshot(snapshotPath, 25.0, 25.0).rejected, 1u);
+    
+    // Обрезанный файл распознается по размеру
+    std::filesystem::resize_file(snapshotPath, 80);
+    EXPECT_THROW(ScenarioLoader::loadSnapshot(snapshotPath, 500.0, 500.0), std::runtime_error);
+    EXPECT_THROW(ScenarioLoader::load("no_such_scenario.txt", 500.0, 500.0, pool), std::runtime_error);
+    
+    std::remove(textPath);
+    std::remove(snapshotPath);
+}
+
+TEST(ScenarioLoaderTest, RejectsOversizedHeaderCounts) {
+    const char* snapshotPath = "test_bad_header.bin";
+    auto writeHeader = [&](uint64_t npcCount, uint64_t namesBytes) {
+        ScenarioHeader header{};
+        std::memcpy(header.magic, ScenarioHeader::MAGIC, sizeof(header.magic));
+        header.version = ScenarioHeader::VERSION;
+        header.headerSize = sizeof(ScenarioHeader);
+        header.npcCount = npcCount;
+        header.namesBytes = namesBytes;
+        header.mapWidth = 500.0;
+        header.mapHeight = 500.0;
+        std::vector<char> image(256, 0);
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::ofstream out(snapshotPath, std::ios::binary);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    };
+    
+    // Без проверки раскладка для таких значений переполняется и выходит
+    // короче файла, а чтение уходит далеко за его конец
+    writeHeader(UINT64_MAX, 0);
+    EXPECT_THROW(ScenarioLoader::loadSnapshot(snapshotPath, 500.0, 500.0), std::runtime_error);
+    
+    writeHeader(1, UINT64_MAX - 64);
+    EXPECT_THROW(ScenarioLoader::loadSnapshot(snapshotPath, 500.0, 500.0), std::runtime_error);
+    
+    std::remove(snapshotPath);
+}
+
+TEST(ScenarioLoaderTest, GameStartsFromScenario) {
+    const char* textPath = "test_game_scenario.txt";
+    const char* snapshotPath = "test_game_scenario.bin";
+    {
+        std::ofstream out(textPath);
+        for (int i = 0; i < 100; i++) {
+            out << NPC_KIND_NAMES[i % 3] << " Боец_" << i << " " << 1 + i << " " << 50 << "\n";
+        }
+    }
+    
+    SimulationConfig config;
+    config.headless = true;
+    config.maxTicks = 10;
+    config.durationSeconds = 0;
+    config.seed = 4;
+    config.scenarioFile = textPath;
+    config.saveScenarioFile = snapshotPath;
+    {
+        GameManager game(config);
+        game.start();
+        game.joinAll();
+        EXPECT_EQ(game.getReport().ticks, 10u);
+    }
+    
+    // Снимок, сохраненный при старте, дает тот же мир и тот же ход боя
+    SimulationConfig fromSnapshot = config;
+    fromSnapshot.scenarioFile = snapshotPath;
+    fromSnapshot.saveScenarioFile.clear();
+    SimulationConfig fromText = config;
+    fromText.saveScenarioFile.clear();
+    
+    GameManager first(fromText);
+    GameManager second(fromSnapshot);
+    first.start();
+    second.start();
+    first.joinAll();
+    second.joinAll();
+    EXPECT_EQ(first.getReport().deaths, second.getReport().deaths);
+    EXPECT_EQ(first.getReport().fights, second.getReport().fights);
+    
+    std::remove(textPath);
+    std::remove(snapshotPath);
+}
+
 // ==================== ТЕСТЫ ДЛЯ OBSERVER ====================
 
 TEST(ObserverTest, ConsoleObserverCreation) {
@@ -194,6 +1430,9 @@ TEST(ObserverTest, ThreadSafety) {
         t.join();
     }
     
+    // Журнал асинхронный: дожидаемся записи перед чтением файла
+    observer.flush();
+    
     // Проверяем, что файл существует и не поврежден
     std::ifstream file("thread_test.txt");
     EXPECT_TRUE(file.is_open());
@@ -212,6 +1451,373 @@ TEST(ObserverTest, ThreadSafety) {
     std::remove("thread_test.txt");
 }
 
+TEST(ObserverTest, AsyncLoggerWritesWholeLines) {
+    const char* path = "async_logger_test.txt";
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    
+    {
+        // Маленькое кольцо заставляет производителей ждать фоновый поток
+        AsyncLogger logger(fd, "[T] ", true, 16);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&logger, i]() {
+                for (int j = 0; j < 500; j++) {
+                    logger.log({"Убийца_", std::to_string(i), " убил ", std::to_string(j)});
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        
+        EXPECT_TRUE(logger.flush());
+        EXPECT_EQ(logger.written(), 2000u);
+        logger.log({"после flush"});
+    }
+    
+    // Деструктор дописывает очередь до закрытия дескриптора
+    std::ifstream file(path);
+    int lineCount = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        EXPECT_EQ(line.rfind("[T] ", 0), 0u);
+        EXPECT_EQ(line.substr(12, 3), " - ");
+        lineCount++;
+    }
+    EXPECT_EQ(lineCount, 2001);
+    
+    file.close();
+    std::remove(path);
+}
+
+TEST(ObserverTest, BinaryLogObserverAppendsRecords) {
+    const char* path = "binary_log_test.bin";
+    std::remove(path);
+    
+    Knight knight("Рыцарь", 12, 34);
+    Orc orc("Орк", 56, 78);
+    orc.die();
+    DeathEvent event{7, knight, orc};
+    
+    {
+        BinaryLogObserver observer(path);
+        ASSERT_TRUE(observer.isOpen());
+        for (int i = 0; i < 3; i++) observer.onDeathEvent(event);
+        EXPECT_EQ(observer.recordCount(), 3u);
+    }
+    
+    // Повторное открытие дописывает журнал, а не начинает его заново
+    {
+        BinaryLogObserver observer(path);
+        EXPECT_EQ(observer.recordCount(), 3u);
+        observer.onDeathEvent(DeathEvent{8, orc, knight});
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    BattleLogHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ASSERT_TRUE(header.isValid());
+    EXPECT_EQ(header.recordCount, 4u);
+    
+    std::vector<BattleLogRecord> records(header.recordCount);
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(BattleLogRecord));
+    EXPECT_TRUE(file.good());
+    EXPECT_EQ(file.peek(), EOF);
+    
+    EXPECT_EQ(records[0].tick, 7u);
+    EXPECT_EQ(records[0].killerId, knight.getRngId());
+    EXPECT_EQ(records[0].victimId, orc.getRngId());
+    EXPECT_EQ(records[0].killerKind, static_cast<uint8_t>(NpcKind::Knight));
+    EXPECT_EQ(records[0].victimKind, static_cast<uint8_t>(NpcKind::Orc));
+    EXPECT_FLOAT_EQ(records[0].x, 56.0f);
+    EXPECT_FLOAT_EQ(records[0].y, 78.0f);
+    EXPECT_EQ(records[3].tick, 8u);
+    EXPECT_EQ(records[3].victimKind, static_cast<uint8_t>(NpcKind::Knight));
+    
+    file.close();
+    std::remove(path);
+}
+
+TEST(ObserverTest, BinaryLogStopsAtFirstLostRecord) {
+    const char* path = "binary_log_lost.bin";
+    std::remove(path);
+    
+    Knight knight("Рыцарь", 12, 34);
+    Orc orc("Орк", 56, 78);
+    DeathEvent event{3, knight, orc};
+    
+    {
+        BinaryLogObserver observer(path);
+        ASSERT_TRUE(observer.isOpen());
+        
+        // Заполняем начальную емкость, затем запрещаем файлу расти
+        size_t initial = 1 << 16;
+        for (size_t i = 0; i < initial; i++) observer.onDeathEvent(event);
+        
+        rlimit saved{};
+        ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &saved), 0);
+        rlimit limited = saved;
+        limited.rlim_cur = sizeof(BattleLogHeader) + initial * sizeof(BattleLogRecord);
+        auto previous = std::signal(SIGXFSZ, SIG_IGN);
+        ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &limited), 0);
+        observer.onDeathEvent(event);
+        ::setrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, previous);
+        
+        // Файл снова может расти, но после пустого слота журнал не продолжается
+        observer.onDeathEvent(event);
+        EXPECT_TRUE(observer.isTruncated());
+        EXPECT_EQ(observer.recordCount(), initial);
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    BattleLogHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    ASSERT_TRUE(header.isValid());
+    EXPECT_EQ(header.recordCount, 1u << 16);
+    
+    std::vector<BattleLogRecord> records(header.recordCount);
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(BattleLogRecord));
+    EXPECT_TRUE(std::all_of(records.begin(), records.end(), [](const BattleLogRecord& r) { return r.tick == 3; }));
+    
+    file.close();
+    std::remove(path);
+}
+
+// ==================== ТЕСТЫ ДЛЯ TICK SCHEDULER ====================
+
+TEST(TickSchedulerTest, FixedTimestepPacesTicks) {
+    TickScheduler scheduler(5ms, OverrunPolicy::CatchUp);
+    
+    auto begin = std::chrono::steady_clock::now();
+    scheduler.run([](uint64_t tick) { return tick < 20; });
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    
+    // 20 тиков занимают 19 полных шагов расписания
+    EXPECT_EQ(scheduler.getStats().ticks, 20u);
+    EXPECT_GE(elapsed, 95ms);
+    EXPECT_EQ(scheduler.getStats().skipped, 0u);
+}
+
+TEST(TickSchedulerTest, OverrunPolicies) {
+    auto slowThird = [](uint64_t tick) {
+        if (tick == 3) std::this_thread::sleep_for(45ms);
+        return tick < 10;
+    };
+    
+    // CatchUp отрабатывает отставание тиками подряд, ничего не выбрасывая
+    TickScheduler catchUp(10ms, OverrunPolicy::CatchUp);
+    catchUp.run(slowThird);
+    EXPECT_EQ(catchUp.getStats().ticks, 10u);
+    EXPECT_GE(catchUp.getStats().overruns, 1u);
+    EXPECT_EQ(catchUp.getStats().skipped, 0u);
+    EXPECT_GE(catchUp.getStats().maxDuration, 45ms);
+    
+    // Skip выбрасывает слоты, начало которых уже прошло
+    TickScheduler skip(10ms, OverrunPolicy::Skip);
+    skip.run(slowThird);
+    EXPECT_EQ(skip.getStats().ticks, 10u);
+    EXPECT_EQ(skip.getStats().overruns, 1u);
+    EXPECT_GE(skip.getStats().skipped, 4u);
+}
+
+TEST(TickSchedulerTest, UnthrottledRunIsBoundByTicksNotWallClock) {
+    SimulationConfig config;
+    config.npcCount = 100;
+    config.tickRate = 50;
+    config.durationSeconds = 2;
+    config.unthrottled = true;
+    config.renderEvery = 1000;
+    config.seed = 5;
+    
+    // 2 секунды симулированного времени при 50 тиках в секунду - ровно 100 тиков
+    GameManager game(config);
+    game.start();
+    game.joinAll();
+    
+    SimulationReport report = game.getReport();
+    EXPECT_EQ(report.ticks, 100u);
+    EXPECT_EQ(report.tickStats.ticks, 100u);
+    EXPECT_LT(report.seconds, 2.0);
+}
+
+// ==================== ТЕСТЫ ДЛЯ METRICS ====================
+
+TEST(MetricsTest, HistogramPercentilesWithinBucketError) {
+    Metrics metrics;
+    for (uint64_t ns = 1; ns <= 100000; ns++) {
+        metrics.record(Phase::Move, ns * 10);
+    }
+    
+    HistogramSnapshot s = metrics.snapshot(Phase::Move);
+    EXPECT_EQ(s.total, 100000u);
+    EXPECT_EQ(s.maxValue, 1000000u);
+    EXPECT_NEAR(s.meanNs(), 500005.0, 1.0);
+    // Корзины 1/16 степени двойки: верхняя граница не дальше ~6.25% от точного значения
+    EXPECT_NEAR(static_cast<double>(s.percentile(0.5)), 500000.0, 500000.0 * 0.0625);
+    EXPECT_NEAR(static_cast<double>(s.percentile(0.99)), 990000.0, 990000.0 * 0.0625);
+    EXPECT_EQ(s.percentile(1.0), 1000000u);
+    
+    // Малые значения хранятся точно, огромные уходят в последнюю корзину
+    EXPECT_EQ(LatencyHistogram::bucketFor(7), 7u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(UINT64_MAX), LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(MetricsTest, ShardsFromAllThreadsAreMerged) {
+    Metrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&metrics, t] {
+            for (int i = 0; i < 1000; i++) {
+                metrics.record(Phase::Resolve, 1000 * (t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    HistogramSnapshot s = metrics.snapshot(Phase::Resolve);
+    EXPECT_EQ(s.total, 4000u);
+    EXPECT_EQ(s.sum, 1000u * (1000 + 2000 + 3000 + 4000));
+    EXPECT_EQ(s.maxValue, 4000u);
+    EXPECT_EQ(metrics.snapshot(Phase::Move).total, 0u);
+}
+
+TEST(MetricsTest, PrometheusFormatAndDumpSignal) {
+    Metrics metrics;
+    metrics.record(Phase::Move, 2000);      // 2 мкс
+    metrics.record(Phase::Move, 3000000);   // 3 мс
+    metrics.setGauge(Gauge::Alive, 42);
+    
+    std::string text = metrics.formatPrometheus();
+    EXPECT_NE(text.find("# TYPE npc_phase_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("npc_phase_seconds_bucket{phase=\"move\",le=\"2.5e-06\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("npc_phase_seconds_bucket{phase=\"move\",le=\"+Inf\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("npc_phase_seconds_count{phase=\"move\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("npc_alive 42"), std::string::npos);
+    
+    Metrics::installDumpSignalHandler();
+    EXPECT_FALSE(Metrics::consumeDumpRequest());
+    std::raise(SIGUSR1);
+    EXPECT_TRUE(Metrics::consumeDumpRequest());
+    EXPECT_FALSE(Metrics::consumeDumpRequest());
+    EXPECT_NE(metrics.formatTable().find("move"), std::string::npos);
+}
+
+TEST(MetricsTest, GameRecordsPhasesWhenEnabled) {
+    const char* path = "test_metrics.prom";
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 200;
+    config.maxTicks = 50;
+    config.durationSeconds = 0;
+    config.seed = 3;
+    config.metrics = true;
+    config.metricsFile = path;
+    
+    GameManager game(config);
+    game.start();
+    game.joinAll();
+    
+    Metrics* metrics = game.getMetrics();
+    ASSERT_NE(metrics, nullptr);
+    EXPECT_EQ(metrics->snapshot(Phase::Tick).total, 50u);
+    EXPECT_EQ(metrics->snapshot(Phase::Move).total, 50u);
+    EXPECT_EQ(metrics->snapshot(Phase::Detect).total, 50u);
+    EXPECT_EQ(metrics->snapshot(Phase::Render).total, 0u);
+    EXPECT_EQ(metrics->getGauge(Gauge::Ticks), 50);
+    
+    std::ifstream file(path);
+    ASSERT_TRUE(file.is_open());
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_NE(content.str().find("npc_ticks_total 50"), std::string::npos);
+    file.close();
+    std::remove(path);
+    
+    // Без флага метрики не создаются
+    SimulationConfig plain;
+    GameManager quiet(plain);
+    EXPECT_EQ(quiet.getMetrics(), nullptr);
+}
+
+// ==================== ТЕСТЫ ДЛЯ TRACER ====================
+
+TEST(TracerTest, RecordsSpansAndContendedLockWaits) {
+    const char* path = "test_trace.json";
+    Tracer::start(4);
+    
+    std::mutex mutex;
+    std::unique_lock held(mutex);
+    std::thread waiter([&mutex]() {
+        Tracer::setThreadName("waiter");
+        auto lock = tracedLock(mutex, "wait test");
+    });
+    std::this_thread::sleep_for(20ms);
+    held.unlock();
+    waiter.join();
+    
+    {
+        // Свободный мьютекс не дает интервала ожидания
+        TraceSpan span("outer");
+        auto lock = tracedLock(mutex, "wait free");
+    }
+    for (int i = 0; i < 10; i++) {
+        TraceSpan span("overflow");
+    }
+    Tracer::stop();
+    
+    { TraceSpan span("after stop"); }
+    
+    EXPECT_EQ(Tracer::eventCount(), 5u);
+    EXPECT_EQ(Tracer::droppedCount(), 7u);
+    ASSERT_TRUE(Tracer::writeJson(path));
+    
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string json = content.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\"", 0), 0u);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"waiter\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"wait test\",\"cat\":\"lock\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+    EXPECT_EQ(json.find("wait free"), std::string::npos);
+    EXPECT_EQ(json.find("after stop"), std::string::npos);
+    file.close();
+    std::remove(path);
+}
+
+TEST(TracerTest, GameWritesTraceOnShutdown) {
+    const char* path = "test_game_trace.json";
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 3000;   // несколько кусков на фазу, чтобы работал пул
+    config.mapWidth = config.mapHeight = 800;
+    config.maxTicks = 20;
+    config.durationSeconds = 0;
+    config.threads = 2;
+    config.seed = 8;
+    config.traceFile = path;
+    
+    {
+        GameManager game(config);
+        game.start();
+        game.joinAll();
+    }
+    EXPECT_FALSE(Tracer::isActive());
+    
+    std::ifstream file(path);
+    ASSERT_TRUE(file.is_open());
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string json = content.str();
+    EXPECT_NE(json.find("\"args\":{\"name\":\"simulation\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"pool-1\"}"), std::string::npos);
+    for (const char* phase : {"tick", "move", "detect", "resolve", "notify", "parallelFor"}) {
+        EXPECT_NE(json.find(std::string("\"name\":\"") + phase + "\""), std::string::npos) << phase;
+    }
+    file.close();
+    std::remove(path);
+}
+
 // ==================== ТЕСТЫ ДЛЯ GAME MANAGER ====================
 
 class GameManagerTest : public ::testing::Test {
@@ -282,6 +1888,157 @@ TEST_F(GameManagerTest, MapBoundariesRespected) {
     game->joinAll();
 }
 
+TEST_F(GameManagerTest, SurvivorsMatchStoredNpcsAfterTicks) {
+    const char* path = "test_survivors.prom";
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 4000;
+    config.seed = 13;
+    config.metrics = true;
+    config.metricsFile = path;
+    
+    for (uint32_t ticks : {1u, 5u}) {
+        GameManager world(config);
+        world.runTicks(ticks);
+        ASSERT_GT(world.getStoredNpcCount(), 0u);
+        
+        // Погибшие на последнем тике в итог не попадают
+        testing::internal::CaptureStdout();
+        world.printSurvivors();
+        std::string output = testing::internal::GetCapturedStdout();
+        std::string expected = "Всего выжило: " + std::to_string(world.getStoredNpcCount()) + "\n";
+        EXPECT_NE(output.find(expected), std::string::npos) << "тиков: " << ticks;
+        EXPECT_EQ(world.getMetrics()->getGauge(Gauge::Alive), static_cast<int64_t>(world.getStoredNpcCount()));
+    }
+    std::remove(path);
+}
+
+TEST_F(GameManagerTest, MapShowsWorldAfterFights) {
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 9;
+    config.mapWidth = config.mapHeight = 30;
+    config.seed = 1;
+    
+    GameManager world(config);
+    world.configureRenderer(1, 1);
+    world.runTicks(1);
+    ASSERT_LT(world.getStoredNpcCount(), 9u);
+    
+    // Одна клетка на всю карту: в ней число NPC, переживших бои тика
+    testing::internal::CaptureStdout();
+    world.printMap();
+    std::string frame = testing::internal::GetCapturedStdout();
+    std::string cell = "\n" + std::to_string(world.getStoredNpcCount()) + " \n";
+    EXPECT_NE(frame.find(cell), std::string::npos);
+}
+
+TEST_F(GameManagerTest, TickResolvesMorePairsThanQueueCapacity) {
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 20000;
+    config.mapWidth = config.mapHeight = 2000;
+    config.fightQueueCapacity = 64;
+    config.seed = 9;
+    config.threads = 1;
+    
+    GameManager game(config, BackpressurePolicy::DropNewest);
+    game.runTicks(1);
+    
+    // Пар за тик много больше емкости очереди, но ни одна не потеряна
+    EXPECT_GT(game.getReport().fights, 64u * 20);
+    EXPECT_EQ(game.getFightQueueDropped(), 0u);
+    EXPECT_EQ(game.getFightQueueDepth(), 0u);
+    
+    EXPECT_THROW(GameManager(config, BackpressurePolicy::Block), std::invalid_argument);
+}
+
+TEST_F(GameManagerTest, TickEndsWithOnlyLivingNpcsStored) {
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 2000;
+    config.mapWidth = config.mapHeight = 400;
+    config.seed = 5;
+    config.threads = 2;
+    
+    GameManager game(config);
+    game.runTicks(100);
+    SimulationReport report = game.getReport();
+    ASSERT_GT(report.deaths, 0u);
+    EXPECT_EQ(game.getStoredNpcCount(), 2000u - report.deaths);
+    
+    // Уплотнение детерминировано: тот же мир дает тот же итог
+    GameManager again(config);
+    again.runTicks(100);
+    EXPECT_EQ(again.getReport().deaths, report.deaths);
+    EXPECT_EQ(again.getReport().fights, report.fights);
+}
+
+TEST(SimulationConfigTest, ParsesArgsAndFile) {
+    const char* path = "simulation_test.conf";
+    {
+        std::ofstream file(path);
+        file << "# нагрузочный прогон\n"
+             << "npcs = 2000\n"
+             << "width = 400\n"
+             << "render-mode = diff\n";
+    }
+    
+    const char* argv[] = {"main", "--config", path, "--height=300", "--headless", "--ticks", "50", "--seed", "7"};
+    SimulationConfig config = SimulationConfig::fromArgs(9, argv);
+    
+    EXPECT_EQ(config.npcCount, 2000);
+    EXPECT_EQ(config.mapWidth, 400.0);
+    EXPECT_EQ(config.mapHeight, 300.0);
+    EXPECT_EQ(config.renderMode, RenderMode::Diff);
+    EXPECT_TRUE(config.headless);
+    EXPECT_EQ(config.maxTicks, 50u);
+    EXPECT_EQ(config.seed, 7u);
+    EXPECT_EQ(config.fightRange, 10.0);
+    
+    const char* unknown[] = {"main", "--speed", "3"};
+    EXPECT_THROW(SimulationConfig::fromArgs(3, unknown), std::invalid_argument);
+    const char* badNumber[] = {"main", "--npcs", "много"};
+    EXPECT_THROW(SimulationConfig::fromArgs(3, badNumber), std::invalid_argument);
+    const char* badRange[] = {"main", "--fight-range", "0"};
+    EXPECT_THROW(SimulationConfig::fromArgs(3, badRange), std::invalid_argument);
+    
+    std::remove(path);
+}
+
+TEST(SimulationConfigTest, RejectsNonFiniteNumbers) {
+    for (const char* key : {"--width", "--height", "--fight-range", "--neighbour-skin",
+                            "--tick-rate", "--duration", "--stats-interval"}) {
+        for (const char* value : {"inf", "nan", "-inf"}) {
+            const char* argv[] = {"main", key, value};
+            EXPECT_THROW(SimulationConfig::fromArgs(3, argv), std::invalid_argument) << key << " " << value;
+        }
+    }
+    
+    const char* finite[] = {"main", "--width", "1e3", "--tick-rate", "0.5"};
+    EXPECT_NO_THROW(SimulationConfig::fromArgs(5, finite));
+}
+
+TEST(SimulationConfigTest, HeadlessRunStopsAtTickLimit) {
+    SimulationConfig config;
+    config.headless = true;
+    config.npcCount = 300;
+    config.maxTicks = 200;
+    config.durationSeconds = 0;
+    config.seed = 11;
+    
+    GameManager game(config);
+    game.start();
+    game.joinAll();
+    
+    SimulationReport report = game.getReport();
+    EXPECT_EQ(report.ticks, 200u);
+    EXPECT_GT(report.fights, 0u);
+    EXPECT_GT(report.deaths, 0u);
+    EXPECT_LE(report.deaths, 300u);
+    EXPECT_GT(report.ticksPerSecond(), 0.0);
+}
+
 // ==================== ИНТЕГРАЦИОННЫЕ ТЕСТЫ ====================
 
 TEST(IntegrationTest, FullCombatCycle) {
@@ -336,7 +2093,6 @@ TEST(IntegrationTest, MultiThreadStressTest) {
     EXPECT_NO_THROW();
 }
 
-
 // ==================== ТЕСТЫ ДЛЯ ПОТОКОВ ====================
 
 TEST(ThreadTest, ConcurrentAccessToNPC) {
@@ -0,0 +1,77 @@
+#include "thread_pool.h"
+#include "tracer.h"
+#include <string>
+
+ThreadPool::ThreadPool(size_t threadCount) : generation(0), stopping(false), jobFunc(nullptr), jobContext(nullptr),
+    jobCount(0), nextIndex(0), busyWorkers(0) {
+    for (size_t i = 1; i < threadCount; i++) {
+        workers.emplace_back([this, i]() {
+            Tracer::setThreadName("pool-" + std::to_string(i));
+            workerLoop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeCV.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ThreadPool::runJob() {
+    TraceSpan span("parallelFor", "pool");
+    while (true) {
+        size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= jobCount) break;
+        jobFunc(jobContext, index);
+    }
+}
+
+void ThreadPool::dispatch(void (*func)(void*, size_t), void* context, size_t count) {
+    // Пул может использоваться из нескольких потоков игры, циклы выполняются по очереди
+    std::lock_guard dispatchLock(dispatchMutex);
+    {
+        std::lock_guard lock(mutex);
+        jobFunc = func;
+        jobContext = context;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeCV.notify_all();
+    
+    runJob();
+    
+    // Ожидание отстающих потоков пула - простой вызывающего потока
+    TraceSpan span("pool barrier", "wait");
+    std::unique_lock lock(mutex);
+    doneCV.wait(lock, [this]() { return busyWorkers == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+    
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            wakeCV.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+        
+        runJob();
+        
+        {
+            std::lock_guard lock(mutex);
+            if (--busyWorkers == 0) {
+                doneCV.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+// Пул потоков фиксированного размера для параллельных циклов внутри тика.
+// Вызывающий поток тоже выполняет работу, поэтому при threadCount == 1
+// дополнительных потоков не создается и цикл выполняется на месте.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex dispatchMutex;
+    std::mutex mutex;
+    std::condition_variable wakeCV;
+    std::condition_variable doneCV;
+    uint64_t generation;
+    bool stopping;
+
+    void (*jobFunc)(void*, size_t);
+    void* jobContext;
+    size_t jobCount;
+    std::atomic<size_t> nextIndex;
+    size_t busyWorkers;
+
+    void workerLoop();
+    void runJob();
+    void dispatch(void (*func)(void*, size_t), void* context, size_t count);
+
+public:
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // Вызывает func(i) для всех i из [0, count); индексы раздаются динамически
+    template <typename Func>
+    void parallelFor(size_t count, Func&& func) {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; i++) func(i);
+            return;
+        }
+        
+        using F = std::remove_reference_t<Func>;
+        void* context = const_cast<void*>(static_cast<const void*>(std::addressof(func)));
+        dispatch([](void* ctx, size_t i) { (*static_cast<F*>(ctx))(i); }, context, count);
+    }
+};
@@ -0,0 +1,51 @@
+#include "tick_scheduler.h"
+#include <algorithm>
+#include <thread>
+
+TickScheduler::TickScheduler(Clock::duration step, OverrunPolicy overrun, size_t catchUpLimit)
+    : timestep(std::max(step, Clock::duration::zero())), policy(overrun), maxCatchUp(catchUpLimit), stopping(false) {}
+
+void TickScheduler::run(const std::function<bool(uint64_t)>& tick) {
+    stopping.store(false, std::memory_order_release);
+    
+    Clock::time_point next = Clock::now();
+    size_t lateStreak = 0;
+    uint64_t number = 0;
+    
+    while (!stopping.load(std::memory_order_acquire)) {
+        Clock::time_point begin = Clock::now();
+        bool more = tick(++number);
+        Clock::time_point end = Clock::now();
+        
+        Clock::duration spent = end - begin;
+        stats.ticks++;
+        stats.lastDuration = spent;
+        stats.maxDuration = std::max(stats.maxDuration, spent);
+        stats.totalDuration += spent;
+        
+        if (!more) break;
+        if (isUnthrottled()) continue;
+        
+        next += timestep;
+        if (end <= next) {
+            lateStreak = 0;
+            std::this_thread::sleep_until(next);
+            continue;
+        }
+        
+        stats.overruns++;
+        if (policy == OverrunPolicy::CatchUp && lateStreak < maxCatchUp) {
+            // Следующий тик сразу: расписание не сдвигается, отставание отрабатывается
+            lateStreak++;
+            continue;
+        }
+        
+        // Все слоты, начало которых уже прошло, выбрасываются; следующий
+        // тик начнется в первом будущем слоте
+        auto missed = (end - next) / timestep + 1;
+        stats.skipped += static_cast<uint64_t>(missed);
+        next += missed * timestep;
+        lateStreak = 0;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+enum class OverrunPolicy {
+    CatchUp,  // опоздавшие тики выполняются подряд без пауз, пока не догонят расписание
+    Skip,     // пропущенные слоты расписания выбрасываются
+};
+
+struct TickStats {
+    using Duration = std::chrono::steady_clock::duration;
+
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;   // тиков, закончившихся позже начала следующего слота
+    uint64_t skipped = 0;    // слотов расписания, выброшенных без выполнения
+    Duration lastDuration{};
+    Duration maxDuration{};
+    Duration totalDuration{};
+
+    double meanMs() const {
+        return ticks ? std::chrono::duration<double, std::milli>(totalDuration).count() / ticks : 0.0;
+    }
+    double maxMs() const { return std::chrono::duration<double, std::milli>(maxDuration).count(); }
+};
+
+// Планировщик с фиксированным шагом симуляции: тик k начинается в момент
+// start + k * timestep. Нулевой шаг - режим без ограничения скорости.
+// Статистику можно читать из самого тика или после run().
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Сколько тиков подряд CatchUp выполняет без пауз, прежде чем сдвинуть расписание
+    static constexpr size_t DEFAULT_MAX_CATCH_UP = 5;
+
+private:
+    Clock::duration timestep;
+    OverrunPolicy policy;
+    size_t maxCatchUp;
+    std::atomic<bool> stopping;
+    TickStats stats;
+
+public:
+    TickScheduler(Clock::duration step, OverrunPolicy overrun, size_t catchUpLimit = DEFAULT_MAX_CATCH_UP);
+
+    // Вызывает tick(номер) по расписанию, пока тот возвращает true и не вызван stop()
+    void run(const std::function<bool(uint64_t)>& tick);
+    void stop() { stopping.store(true, std::memory_order_release); }
+
+    bool isUnthrottled() const { return timestep == Clock::duration::zero(); }
+    Clock::duration getTimestep() const { return timestep; }
+    const TickStats& getStats() const { return stats; }
+};
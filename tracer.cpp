@@ -0,0 +1,160 @@
+#include "tracer.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Tracer::active{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    int64_t beginNs;
+    int64_t endNs;
+};
+
+// Буфер одного потока. Пишет только владелец; size публикуется с release,
+// поэтому записанные события можно читать, не останавливая поток.
+struct ThreadBuffer {
+    uint32_t tid;
+    std::string name;
+    std::unique_ptr<TraceEvent[]> events;
+    size_t capacity;
+    std::atomic<size_t> size{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+std::atomic<uint64_t> currentSession{0};
+size_t eventsPerThread = Tracer::DEFAULT_EVENTS_PER_THREAD;
+std::chrono::steady_clock::time_point origin;
+
+struct LocalState {
+    uint64_t session = 0;
+    ThreadBuffer* buffer = nullptr;
+    std::string name;
+};
+thread_local LocalState local;
+
+ThreadBuffer* localBuffer() {
+    uint64_t session = currentSession.load(std::memory_order_acquire);
+    if (local.session == session) return local.buffer;
+
+    std::lock_guard lock(registryMutex);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = static_cast<uint32_t>(buffers.size() + 1);
+    buffer->name = local.name.empty() ? "thread " + std::to_string(buffer->tid) : local.name;
+    buffer->capacity = eventsPerThread;
+    buffer->events = std::make_unique<TraceEvent[]>(eventsPerThread);
+    buffers.push_back(std::move(buffer));
+
+    local.session = session;
+    local.buffer = buffers.back().get();
+    return local.buffer;
+}
+
+void writeEscaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+}
+
+}
+
+void Tracer::start(size_t capacity) {
+    std::lock_guard lock(registryMutex);
+    // Буферы прошлой сессии освобождаются: start вызывают, пока никто не пишет
+    buffers.clear();
+    eventsPerThread = capacity > 0 ? capacity : DEFAULT_EVENTS_PER_THREAD;
+    origin = std::chrono::steady_clock::now();
+    currentSession.fetch_add(1, std::memory_order_release);
+    active.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    active.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    local.name = name;
+    if (local.session == currentSession.load(std::memory_order_acquire) && local.buffer) {
+        std::lock_guard lock(registryMutex);
+        local.buffer->name = name;
+    }
+}
+
+void Tracer::record(const char* name, const char* category,
+                    std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end) {
+    ThreadBuffer* buffer = localBuffer();
+
+    size_t index = buffer->size.load(std::memory_order_relaxed);
+    if (index >= buffer->capacity) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[index] = TraceEvent{
+        name, category,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - origin).count(),
+    };
+    buffer->size.store(index + 1, std::memory_order_release);
+}
+
+size_t Tracer::eventCount() {
+    std::lock_guard lock(registryMutex);
+    size_t total = 0;
+    for (const auto& buffer : buffers) {
+        total += buffer->size.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+uint64_t Tracer::droppedCount() {
+    std::lock_guard lock(registryMutex);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers) {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool Tracer::writeJson(const std::string& path) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        std::lock_guard lock(registryMutex);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"npc-simulation\"}}";
+
+        file << std::fixed << std::setprecision(3);
+        for (const auto& buffer : buffers) {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                 << ",\"args\":{\"name\":\"";
+            writeEscaped(file, buffer->name);
+            file << "\"}}";
+
+            // Полные события "X": время начала и длительность в микросекундах
+            size_t size = buffer->size.load(std::memory_order_acquire);
+            for (size_t i = 0; i < size; i++) {
+                const TraceEvent& event = buffer->events[i];
+                file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                     << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                     << ",\"ts\":" << event.beginNs / 1000.0
+                     << ",\"dur\":" << (event.endNs - event.beginNs) / 1000.0 << "}";
+            }
+        }
+        file << "\n]}\n";
+        if (!file.good()) return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Трассировка активности потоков в формате Chrome Trace Event (открывается
+// в Perfetto и chrome://tracing). Каждый поток пишет интервалы в свой буфер
+// фиксированного размера без блокировок; JSON собирается при остановке.
+// Пока трассировка выключена, TraceSpan и tracedLock стоят одну загрузку флага.
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 1 << 16;
+
+    // Начинает новую сессию: буферы прошлой сессии сбрасываются
+    static void start(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    static void stop();
+    static bool isActive() { return active.load(std::memory_order_relaxed); }
+
+    // Имя потока в трассе; можно задавать и до start()
+    static void setThreadName(const std::string& name);
+
+    // name и category должны жить до записи JSON (обычно это литералы)
+    static void record(const char* name, const char* category,
+                       std::chrono::steady_clock::time_point begin,
+                       std::chrono::steady_clock::time_point end);
+
+    static size_t eventCount();
+    static uint64_t droppedCount();
+
+    // Записывает накопленное в path (через временный файл и rename)
+    static bool writeJson(const std::string& path);
+
+private:
+    static std::atomic<bool> active;
+};
+
+// Интервал от создания до разрушения объекта
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    std::chrono::steady_clock::time_point begin;
+    bool enabled;
+
+public:
+    explicit TraceSpan(const char* spanName, const char* spanCategory = "phase")
+        : name(spanName), category(spanCategory), enabled(Tracer::isActive()) {
+        if (enabled) begin = std::chrono::steady_clock::now();
+    }
+
+    ~TraceSpan() {
+        if (enabled) Tracer::record(name, category, begin, std::chrono::steady_clock::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+// Захватывает мьютекс; если он занят и трассировка включена, ожидание
+// попадает в трассу интервалом категории "lock". Свободный мьютекс
+// захватывается через try_lock и интервала не дает.
+template <typename Mutex>
+std::unique_lock<Mutex> tracedLock(Mutex& mutex, const char* name) {
+    if (!Tracer::isActive()) return std::unique_lock<Mutex>(mutex);
+
+    std::unique_lock<Mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        auto begin = std::chrono::steady_clock::now();
+        lock.lock();
+        Tracer::record(name, "lock", begin, std::chrono::steady_clock::now());
+    }
+    return lock;
+}
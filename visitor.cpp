@@ -4,79 +4,202 @@
 #include "orc.h"
 #include "bear.h"
 #include "observer.h"
+#include "spatial_grid.h"
+#include "npc_store.h"
+#include "thread_pool.h"
+#include "neighbour_lists.h"
 #include <iostream>
-#include <random>
+#include <algorithm>
 
 BattleVisitor::BattleVisitor(double r, 
-                           std::vector<std::shared_ptr<NPC>>& n,
+                           const NpcStore& s,
+                           const SpatialGrid& g,
                            std::vector<std::shared_ptr<DeathObserver>>& obs,
-                           std::mutex& queueMutex,
-                           std::queue<FightTask>& queue,
-                           std::condition_variable& cv) : range(r), npcs(n), observers(obs), 
-                           fightQueueMutex(queueMutex), fightQueue(queue), fightQueueCV(cv) {}
+                           FightQueue& queue) : range(r), store(&s), grid(g), neighbourLists(nullptr), observers(obs), fightQueue(queue), currentTick(0),
+    tickPairs(0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{}, PoolAllocator<uint64_t>(pairPool)), deferNotifications(false) {
+    pending.reserve(FLUSH_THRESHOLD);
+}
+
+void BattleVisitor::beginTick(uint32_t tick) {
+    flush();
+    currentTick = tick;
+    tickPairs.clear();
+}
+
+void BattleVisitor::setSource(const NpcStore& source) {
+    store = &source;
+}
 
 void BattleVisitor::visit(NPC& npc) {
-    if (!npc.isAlive()) return;
+    if (!npc.isAttached()) return;
+    visit(npc.getSlot());
+}
+
+void BattleVisitor::collectCandidates(uint32_t slot, std::vector<FightTask>& out) const {
+    if (!store->alive[slot]) return;
     
-    std::shared_ptr<NPC> npcPtr;
-    for (auto& ptr : npcs) {
-        if (ptr.get() == &npc) {
-            npcPtr = ptr;
-            break;
-        }
-    }
+    NpcHandle handle = store->handles[slot];
+    if (!handle.isValid()) return;
     
-    if (!npcPtr) return;
+    double x = store->x[slot];
+    double y = store->y[slot];
+    NpcKind kind = store->type[slot];
+    double rangeSquared = range * range;
     
-    for (auto& other : npcs) {
-        if (!other || other == npcPtr || !other->isAlive()) continue;
+    auto consider = [&](int other) {
+        if (other == static_cast<int>(slot) || !store->alive[other]) return;
+        if (!canFight(kind, store->type[other])) return;
         
-        if (npc.distanceTo(*other) <= range) {
-            FightTask task;
-            task.attacker = npcPtr;
-            task.defender = other;
-            
-            {
-                std::lock_guard lock(fightQueueMutex);
-                fightQueue.push(task);
-            }
-            fightQueueCV.notify_one();
+        double dx = store->x[other] - x;
+        double dy = store->y[other] - y;
+        if (dx * dx + dy * dy > rangeSquared) return;
+        
+        out.push_back(FightTask{handle, store->handles[other], currentTick});
+    };
+    
+    if (neighbourLists) {
+        neighbourLists->forEachCandidate(slot, *store, grid, [&](uint32_t other) { consider(static_cast<int>(other)); });
+    } else {
+        grid.forEachNeighbour(grid.cellCol(x), grid.cellRow(y), consider);
+    }
+}
+
+void BattleVisitor::enqueueUnique(const FightTask& task) {
+    uint32_t low = std::min(task.attacker.index, task.defender.index);
+    uint32_t high = std::max(task.attacker.index, task.defender.index);
+    if (!tickPairs.insert((static_cast<uint64_t>(low) << 32) | high).second) return;
+    
+    pending.push_back(task);
+    if (pending.size() >= FLUSH_THRESHOLD) {
+        flush();
+    }
+}
+
+void BattleVisitor::visit(uint32_t slot) {
+    candidates.clear();
+    collectCandidates(slot, candidates);
+    for (const FightTask& task : candidates) {
+        enqueueUnique(task);
+    }
+}
+
+void BattleVisitor::visitAll(ThreadPool& pool) {
+    size_t count = store->size();
+    size_t chunks = (count + DETECT_CHUNK_SIZE - 1) / DETECT_CHUNK_SIZE;
+    if (chunkTasks.size() < chunks) {
+        chunkTasks.resize(chunks);
+    }
+    
+    // Поиск только читает хранилище, поэтому куски обрабатываются параллельно,
+    // каждый в свой буфер; слияние и дедупликация идут в порядке кусков
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        std::vector<FightTask>& out = chunkTasks[chunk];
+        out.clear();
+        uint32_t end = static_cast<uint32_t>(std::min(count, (chunk + 1) * DETECT_CHUNK_SIZE));
+        for (uint32_t slot = static_cast<uint32_t>(chunk * DETECT_CHUNK_SIZE); slot < end; slot++) {
+            collectCandidates(slot, out);
+        }
+    });
+    
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        for (const FightTask& task : chunkTasks[chunk]) {
+            enqueueUnique(task);
         }
     }
+    flush();
 }
 
-void BattleVisitor::processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender) {
-    if (!attacker->isAlive() || !defender->isAlive()) return;
+void BattleVisitor::flush() {
+    if (pending.empty()) return;
+    if (!drainQueue) {
+        fightQueue.pushBatch(pending.data(), pending.size());
+        pending.clear();
+        return;
+    }
+    
+    size_t offset = 0;
+    while (offset < pending.size()) {
+        size_t left = pending.size() - offset;
+        if (fightQueue.capacity() - fightQueue.depth() < left) {
+            drainQueue();
+        }
+        // Если разбор не освободил места, остаток уходит по политике очереди
+        size_t room = fightQueue.capacity() - fightQueue.depth();
+        size_t batch = room > 0 ? std::min(left, room) : left;
+        fightQueue.pushBatch(pending.data() + offset, batch);
+        offset += batch;
+    }
+    pending.clear();
+}
 
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dice(1, 6);
+void BattleVisitor::processFight(NPC& attacker, NPC& defender, const CounterRng& rng, uint32_t tick) {
+    if (!attacker.isAlive() || !defender.isAlive()) return;
     
-    if (attacker->canDefeat(*defender)) {
-        int attackPower = dice(gen);
-        int defensePower = dice(gen);
+    if (attacker.canDefeat(defender)) {
+        int attackPower = attacker.rollDice(rng, tick, RngPurpose::AttackDice, defender.getRngId());
+        int defensePower = defender.rollDice(rng, tick, RngPurpose::DefenseDice, attacker.getRngId());
         
         if (attackPower > defensePower) {
-            defender->die();
-            notifyObservers(attacker->getName(), attacker->getType(), defender->getName(), defender->getType());
+            defender.die();
+            reportDeath(attacker, defender, tick);
         }
     }
     
-    if (defender->isAlive() && defender->canDefeat(*attacker)) {
-        int attackPower = dice(gen);
-        int defensePower = dice(gen);
+    if (defender.isAlive() && defender.canDefeat(attacker)) {
+        int attackPower = defender.rollDice(rng, tick, RngPurpose::AttackDice, attacker.getRngId());
+        int defensePower = attacker.rollDice(rng, tick, RngPurpose::DefenseDice, defender.getRngId());
         
         if (attackPower > defensePower) {
-            attacker->die();
-            notifyObservers(defender->getName(), defender->getType(), attacker->getName(), attacker->getType());
+            attacker.die();
+            reportDeath(defender, attacker, tick);
         }
     }
 }
 
-void BattleVisitor::notifyObservers(const std::string& killerName, const std::string& killerType, const std::string& victimName, const std::string& victimType) {
+void BattleVisitor::reportDeath(const NPC& killer, const NPC& victim, uint32_t tick) {
+    if (!deferNotifications) {
+        notifyObservers(killer, victim, tick);
+        return;
+    }
+    
+    std::lock_guard lock(pendingDeathsMutex);
+    pendingDeaths.push_back(PendingDeath{&killer, &victim, tick});
+}
+
+size_t BattleVisitor::notifyPending() {
+    std::vector<PendingDeath> deaths;
+    {
+        std::lock_guard lock(pendingDeathsMutex);
+        deaths.swap(pendingDeaths);
+    }
+    
+    // Бои одного тика разрешаются параллельно; сортировка делает порядок
+    // в журналах независимым от расписания потоков
+    std::sort(deaths.begin(), deaths.end(), [](const PendingDeath& a, const PendingDeath& b) {
+        if (a.tick != b.tick) return a.tick < b.tick;
+        if (a.killer->getRngId() != b.killer->getRngId()) return a.killer->getRngId() < b.killer->getRngId();
+        return a.victim->getRngId() < b.victim->getRngId();
+    });
+    
+    for (const PendingDeath& death : deaths) {
+        notifyObservers(*death.killer, *death.victim, death.tick);
+    }
+    
+    // Буфер возвращается, чтобы не выделять память каждый тик
+    size_t count = deaths.size();
+    deaths.clear();
+    {
+        std::lock_guard lock(pendingDeathsMutex);
+        if (pendingDeaths.empty()) pendingDeaths.swap(deaths);
+    }
+    return count;
+}
+
+void BattleVisitor::notifyObservers(const NPC& killer, const NPC& victim, uint32_t tick) {
+    DeathEvent event{tick, killer, victim};
     for (auto& observer : observers) {
         if (observer) {
-            observer->onDeath(killerName + " (" + killerType + ")", victimName + " (" + victimType + ")");
+            observer->onDeathEvent(event);
         }
     }
 }
\ No newline at end of file
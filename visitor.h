@@ -1,38 +1,104 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
 #include <vector>
-#include <queue>
-#include <condition_variable>
+#include <string>
+#include <unordered_set>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "npc_handle.h"
+#include "fight_queue.h"
+#include "node_pool.h"
 
 class NPC;
 class DeathObserver;
-
-struct FightTask {
-    std::shared_ptr<NPC> attacker;
-    std::shared_ptr<NPC> defender;
-};
+class SpatialGrid;
+class NpcStore;
+class CounterRng;
+class ThreadPool;
+class NeighbourLists;
 
 class BattleVisitor {
 private:
     double range;
-    std::vector<std::shared_ptr<NPC>>& npcs;
+    const NpcStore* store;
+    const SpatialGrid& grid;
+    // Если заданы, кандидаты берутся из списков соседей, а не из сетки
+    NeighbourLists* neighbourLists;
     std::vector<std::shared_ptr<DeathObserver>>& observers;
-    std::mutex& fightQueueMutex;
-    std::queue<FightTask>& fightQueue;
-    std::condition_variable& fightQueueCV;
+    FightQueue& fightQueue;
+    
+    static constexpr size_t FLUSH_THRESHOLD = 256;
+    std::vector<FightTask> pending;
+    // Вызывается, когда очереди не хватает места под очередную пачку
+    std::function<void()> drainQueue;
+    
+    // Пары, уже поставленные в очередь на текущем тике (ключ - упорядоченная пара индексов).
+    // Узлы набора берутся из пула и после clear() переиспользуются следующим тиком.
+    uint32_t currentTick;
+    NodePool pairPool;
+    std::unordered_set<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, PoolAllocator<uint64_t>> tickPairs;
+    
+    static constexpr size_t DETECT_CHUNK_SIZE = 2048;
+    std::vector<FightTask> candidates;
+    std::vector<std::vector<FightTask>> chunkTasks;
+    
+    void collectCandidates(uint32_t slot, std::vector<FightTask>& out) const;
+    void enqueueUnique(const FightTask& task);
 
-    void processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender);
-    void notifyObservers(const std::string& killerName, const std::string& killerType, const std::string& victimName, const std::string& victimType);
+    // Смерти, накопленные до фазы уведомления (при deferNotifications)
+    struct PendingDeath {
+        const NPC* killer;
+        const NPC* victim;
+        uint32_t tick;
+    };
+    bool deferNotifications;
+    std::mutex pendingDeathsMutex;
+    std::vector<PendingDeath> pendingDeaths;
+    
+    void notifyObservers(const NPC& killer, const NPC& victim, uint32_t tick);
+    void reportDeath(const NPC& killer, const NPC& victim, uint32_t tick);
     
 public:
     BattleVisitor(double r, 
-                  std::vector<std::shared_ptr<NPC>>& n,
+                  const NpcStore& s,
+                  const SpatialGrid& g,
                   std::vector<std::shared_ptr<DeathObserver>>& obs,
-                  std::mutex& queueMutex,
-                  std::queue<FightTask>& queue,
-                  std::condition_variable& cv);
+                  FightQueue& queue);
+    
+    // Начинает новый тик: задачи помечаются его номером, набор пар очищается
+    void beginTick(uint32_t tick);
+    
+    // Хранилище или кадр мира, по которому ищутся бои
+    void setSource(const NpcStore& source);
+    
+    // Списки должны быть подготовлены (NeighbourLists::prepare) по тому же
+    // кадру, что передан в setSource; nullptr возвращает поиск по сетке
+    void setNeighbourLists(NeighbourLists* lists) { neighbourLists = lists; }
     
     void visit(NPC& npc);
+    void visit(uint32_t slot);
+    
+    // Параллельный поиск боев по всем NPC хранилища с последующим flush()
+    void visitAll(ThreadPool& pool);
+    
+    // Отправляет накопленные задачи в очередь одной пачкой. Если задан
+    // drain, переполнения не бывает: перед пачкой, которая не помещается,
+    // очередь разбирается, и пачка уходит частями по свободному месту.
+    void flush();
+    
+    // Для конвейера, где потребитель очереди работает в том же потоке после
+    // поиска: без разбора задачи сверх емкости очереди терялись бы
+    void setQueueDrain(std::function<void()> drain) { drainQueue = std::move(drain); }
+    
+    // Бой пары с уведомлением наблюдателей о смерти
+    void processFight(NPC& attacker, NPC& defender, const CounterRng& rng, uint32_t tick);
+    
+    // В отложенном режиме смерти копятся до notifyPending(), а не уходят
+    // наблюдателям прямо из потоков разрешения боев
+    void setDeferredNotifications(bool deferred) { deferNotifications = deferred; }
+    
+    // Доставляет отложенные смерти в порядке (тик, убийца, жертва); возвращает их число
+    size_t notifyPending();
 };
\ No newline at end of file
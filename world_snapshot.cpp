@@ -0,0 +1,54 @@
+#include "world_snapshot.h"
+
+WorldSnapshots::Reader& WorldSnapshots::Reader::operator=(Reader&& other) noexcept {
+    if (this != &other) {
+        if (slot) slot->readers.fetch_sub(1, std::memory_order_release);
+        slot = other.slot;
+        other.slot = nullptr;
+    }
+    return *this;
+}
+
+WorldSnapshots::Reader::~Reader() {
+    if (slot) slot->readers.fetch_sub(1, std::memory_order_release);
+}
+
+WorldSnapshots::WorldSnapshots() : latest(-1), skippedCount(0) {}
+
+bool WorldSnapshots::publish(const NpcStore& store, uint32_t tick) {
+    int current = latest.load(std::memory_order_relaxed);
+    
+    for (size_t i = 0; i < FRAME_COUNT; i++) {
+        Slot& slot = slots[i];
+        if (static_cast<int>(i) == current) continue;
+        if (slot.readers.load(std::memory_order_acquire) != 0) continue;
+        
+        slot.frame.tick = tick;
+        slot.frame.npcs.copyStateFrom(store);
+        slot.frame.npcs.releaseSpare();
+        slot.frame.aliveCount = store.aliveCount();
+        
+        latest.store(static_cast<int>(i), std::memory_order_seq_cst);
+        return true;
+    }
+    
+    skippedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+WorldSnapshots::Reader WorldSnapshots::read() const {
+    while (true) {
+        int index = latest.load(std::memory_order_seq_cst);
+        if (index < 0) return Reader();
+        
+        const Slot& slot = slots[index];
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        
+        // Кадр мог быть переиспользован писателем между загрузкой индекса
+        // и регистрацией читателя: тогда он уже не последний, пробуем снова
+        if (latest.load(std::memory_order_seq_cst) == index) {
+            return Reader(&slot);
+        }
+        slot.readers.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "npc_store.h"
+
+// Неизменяемый кадр мира: копия горячих массивов хранилища на момент тика
+struct WorldFrame {
+    uint32_t tick = 0;
+    NpcStore npcs;
+    size_t aliveCount = 0;
+};
+
+// Кадры мира с подсчетом читателей (RCU-подобная схема). Единственный писатель
+// заполняет свободный кадр и публикует его одним атомарным сохранением индекса;
+// читатели берут последний опубликованный кадр без блокировок и держат его,
+// пока жив Reader. Писатель никогда не трогает кадр, у которого есть читатели.
+class WorldSnapshots {
+private:
+    static constexpr size_t FRAME_COUNT = 4;
+
+    struct Slot {
+        WorldFrame frame;
+        mutable std::atomic<uint32_t> readers{0};
+    };
+
+    std::array<Slot, FRAME_COUNT> slots;
+    std::atomic<int> latest;
+    std::atomic<uint64_t> skippedCount;
+
+public:
+    class Reader {
+    private:
+        const Slot* slot;
+
+    public:
+        explicit Reader(const Slot* s = nullptr) : slot(s) {}
+        Reader(Reader&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader&& other) noexcept;
+        ~Reader();
+
+        bool valid() const { return slot != nullptr; }
+        const WorldFrame& operator*() const { return slot->frame; }
+        const WorldFrame* operator->() const { return &slot->frame; }
+    };
+
+    WorldSnapshots();
+
+    // Возвращает false, если все свободные кадры заняты читателями и тик пропущен
+    bool publish(const NpcStore& store, uint32_t tick);
+
+    Reader read() const;
+
+    uint64_t skipped() const { return skippedCount.load(std::memory_order_relaxed); }
+};